@@ -0,0 +1,184 @@
+//
+//  Benchmark.cpp
+//  CloudSim
+//
+// Placement microbenchmarks: every policy against synthetic cluster snapshots of 10 to 10,000
+// machines at different VM counts and loads, run against FakeSimulator instead of the real
+// simulator. Reports wall time and heap allocations per placement decision.
+//
+//     make bench
+//     ./benchmark [policy ...]
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+#include "FakeSimulator.hpp"
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Scheduler.hpp"
+
+// Each configuration runs until it has made this many decisions or spent this long, in microseconds
+#define MAX_DECISIONS   2000
+#define MIN_DECISIONS   20
+#define TIME_BUDGET     500000
+// Instructions per task; about a third of a second at full speed
+#define TASK_SIZE       1000000000ull
+
+// Heap allocations while counting is on
+static bool counting = false;
+static uint64_t allocations = 0;
+
+// Every replaceable form is defined so each delete matches its new; GCC warns about mismatches
+// (-Wmismatched-new-delete) at -O2 otherwise
+static void * Allocate(size_t size) {
+    if(counting) {
+        allocations++;
+    }
+    void * memory = malloc(size == 0 ? 1 : size);
+    if(memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+static void Deallocate(void * memory) noexcept {
+    free(memory);
+}
+
+void * operator new(size_t size) {
+    return Allocate(size);
+}
+
+void * operator new[](size_t size) {
+    return Allocate(size);
+}
+
+void operator delete(void * memory) noexcept {
+    Deallocate(memory);
+}
+
+void operator delete[](void * memory) noexcept {
+    Deallocate(memory);
+}
+
+void operator delete(void * memory, size_t) noexcept {
+    Deallocate(memory);
+}
+
+void operator delete[](void * memory, size_t) noexcept {
+    Deallocate(memory);
+}
+
+struct Snapshot {
+    unsigned machines;
+    unsigned vms_per_machine;
+    double load;                                // Resident tasks per core
+};
+
+static const Snapshot snapshots[] = {
+    { 10,    1, 0.25 }, { 10,    4, 0.75 },
+    { 100,   1, 0.25 }, { 100,   4, 0.75 },
+    { 1000,  1, 0.25 }, { 1000,  4, 0.75 },
+    { 10000, 1, 0.25 }, { 10000, 4, 0.75 },
+};
+
+static const char * all_policies[] = { "best", "brute", "greedy" };
+
+static TaskId_t RandomTask(mt19937 & random, Time_t arrival) {
+    static const unsigned memory[] = { 8, 64, 256, 1024 };
+    SLAType_t sla = SLAType_t(random() % NUM_SLAS);
+    // Mostly X86 like the cluster, some ARM; a quarter of the tasks can use a GPU
+    CPUType_t cpu = random() % 4 == 0 ? ARM : X86;
+    Time_t deadline = arrival + TASK_SIZE / 1000 * (sla == SLA0 ? 3 : 12);
+    return FakeSimulator::AddTask(arrival, TASK_SIZE, deadline, LINUX, sla, cpu, random() % 4 == 0, memory[random() % 4]);
+}
+
+static void Run(const char * policy, const Snapshot & snapshot) {
+    mt19937 random(snapshot.machines);
+    FakeSimulator::Reset();
+    unsigned cores = 0;
+    for(unsigned i = 0; i < snapshot.machines; i++) {
+        // A quarter ARM, and every other machine of each type with a GPU
+        CPUType_t cpu = i % 4 == 3 ? ARM : X86;
+        FakeSimulator::AddMachine(cpu, 8, 16384, i % 2 == 1);
+        cores += 8;
+    }
+    unsigned resident = unsigned(snapshot.load * cores);
+    vector<TaskId_t> preload, decisions;
+    for(unsigned i = 0; i < resident; i++) {
+        preload.push_back(RandomTask(random, 0));
+    }
+    for(unsigned i = 0; i < MAX_DECISIONS; i++) {
+        decisions.push_back(RandomTask(random, 1000 + i));
+    }
+
+    setenv("CLOUDSIM_POLICY", policy, 1);
+    Scheduler * scheduler = new Scheduler();
+    scheduler->Init();
+
+    // The snapshot: extra VMs, and the resident tasks dealt round robin over compatible VMs, so the
+    // policy under test only ever sees the decisions being timed
+    vector<vector<VMId_t>> vms_of(snapshot.machines);
+    for(MachineId_t machine_id = 0; machine_id < snapshot.machines; machine_id++) {
+        vms_of[machine_id].push_back(scheduler->Residency().FirstVM(machine_id));
+        for(unsigned v = 1; v < snapshot.vms_per_machine; v++) {
+            vms_of[machine_id].push_back(scheduler->CreateVM(LINUX, Machine_GetCPUType(machine_id), machine_id));
+        }
+    }
+    MachineId_t next = 0;
+    for(TaskId_t task_id : preload) {
+        while(Machine_GetCPUType(next) != RequiredCPUType(task_id) || (IsTaskGPUCapable(task_id) && !scheduler->Machines().HasGPU(next))) {
+            next = (next + 1) % snapshot.machines;
+        }
+        scheduler->AddTask(task_id, vms_of[next][task_id % snapshot.vms_per_machine], SLAPriority(RequiredSLA(task_id)), GetTaskMemory(task_id));
+        next = (next + 1) % snapshot.machines;
+    }
+
+    // Each decision's task completes right away, so the load stays at the snapshot's
+    uint64_t elapsed = 0, allocated = 0;
+    unsigned made = 0;
+    for(TaskId_t task_id : decisions) {
+        if(made >= MIN_DECISIONS && elapsed >= uint64_t(TIME_BUDGET) * 1000) {
+            break;
+        }
+        Time_t now = GetTaskInfo(task_id).arrival;
+        FakeSimulator::SetNow(now);
+        allocations = 0;
+        counting = true;
+        auto start = chrono::steady_clock::now();
+        scheduler->NewTask(now, task_id);
+        auto end = chrono::steady_clock::now();
+        counting = false;
+        elapsed += chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+        allocated += allocations;
+        made++;
+        if(scheduler->Residency().VMOf(task_id) != NO_VM) {
+            FakeSimulator::CompleteTask(task_id);
+            scheduler->TaskComplete(now, task_id);
+        }
+    }
+    delete scheduler;
+
+    printf("%-8s %9u %8u %6.2f %10u %14.0f %14.2f\n", policy, snapshot.machines, snapshot.vms_per_machine, snapshot.load,
+           made, double(elapsed) / made, double(allocated) / made);
+    fflush(stdout);
+}
+
+int main(int argc, char * argv[]) {
+    // FakeSimulator only prints level 0, so building anything above it would only be timed
+    SetLogLevel(0);
+    vector<const char *> policies(all_policies, all_policies + 3);
+    if(argc > 1) {
+        policies.assign(argv + 1, argv + argc);
+    }
+    printf("%-8s %9s %8s %6s %10s %14s %14s\n", "policy", "machines", "VMs/host", "load", "decisions", "ns/decision", "allocs/decision");
+    for(const char * policy : policies) {
+        for(const Snapshot & snapshot : snapshots) {
+            Run(policy, snapshot);
+        }
+    }
+    return 0;
+}
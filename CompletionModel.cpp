@@ -0,0 +1,141 @@
+//
+//  CompletionModel.cpp
+//  CloudSim
+//
+
+#include "CompletionModel.hpp"
+
+#include <algorithm>
+
+#include "Interfaces.h"
+#include "Log.hpp"
+
+// How much faster a GPU-capable task runs on a GPU machine. Measured against the simulator.
+#define GPU_SPEEDUP             20.0
+// How fast tasks run on a machine whose memory is overcommitted. Measured against the simulator.
+#define OVERCOMMIT_SPEED        0.5
+
+// Upper edges of the error histogram bins, as (actual - predicted) / predicted runtime. The last
+// bin catches everything above the last edge.
+static const double error_edges[] = { -0.5, -0.2, -0.05, 0.05, 0.2, 0.5 };
+#define ERROR_BINS (sizeof(error_edges) / sizeof(error_edges[0]) + 1)
+
+void CompletionModel::Init(unsigned num_tasks) {
+    placed_at.assign(num_tasks, 0);
+    predicted.assign(num_tasks, 0);
+    error_histogram.assign(ERROR_BINS, 0);
+}
+
+void CompletionModel::GrowTasks(unsigned num_tasks) {
+    if(num_tasks > placed_at.size()) {
+        placed_at.resize(num_tasks, 0);
+        predicted.resize(num_tasks, 0);
+    }
+}
+
+Time_t CompletionModel::PredictFinish(Time_t now, MachineId_t machine_id, TaskId_t task_id, Priority_t priority) const {
+    LoadJobs(machine_id);
+    TaskInfo_t task_info = GetTaskInfo(task_id);
+    jobs.push_back({ task_info.remaining_instructions / CoreMIPS(machine_id, task_info), priority, true, task_id });
+    return Simulate(now, machine_id, machines.FreeMemory(machine_id) < (long long) GetTaskMemory(task_id));
+}
+
+void CompletionModel::TaskPlaced(Time_t now, TaskId_t task_id) {
+    // The task is on its host already, so it is one of the jobs
+    MachineId_t machine_id = residency.MachineOf(residency.VMOf(task_id));
+    LoadJobs(machine_id);
+    for(Job & job : jobs) {
+        job.target = job.task_id == task_id;
+    }
+    placed_at[task_id] = now;
+    predicted[task_id] = Simulate(now, machine_id, machines.FreeMemory(machine_id) < 0);
+}
+
+void CompletionModel::TaskComplete(Time_t now, TaskId_t task_id) {
+    double runtime = double(predicted[task_id] - placed_at[task_id]);
+    if(runtime <= 0) {
+        return;
+    }
+    double error = (double(now) - double(predicted[task_id])) / runtime;
+    unsigned bin = upper_bound(begin(error_edges), end(error_edges), error) - begin(error_edges);
+    error_histogram[bin]++;
+}
+
+void CompletionModel::Report() const {
+    unsigned total = 0;
+    for(unsigned count : error_histogram) {
+        total += count;
+    }
+    if(total == 0) {
+        return;
+    }
+    for(unsigned bin = 0; bin < ERROR_BINS; bin++) {
+        string range = bin == 0 ? "below " + to_string(int(error_edges[0] * 100)) + "%"
+                     : bin == ERROR_BINS - 1 ? "above " + to_string(int(error_edges[bin - 1] * 100)) + "%"
+                     : to_string(int(error_edges[bin - 1] * 100)) + "% to " + to_string(int(error_edges[bin] * 100)) + "%";
+        LOG("CompletionModel::Report(): Finish time error " + range + ": " + to_string(100.0 * error_histogram[bin] / total) + "% of tasks", 1);
+    }
+}
+
+// The tasks running on the machine, with the work they have left
+void CompletionModel::LoadJobs(MachineId_t machine_id) const {
+    jobs.clear();
+    for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+        for(TaskId_t task_id = residency.FirstTask(vm_id); task_id != NO_TASK; task_id = residency.NextTask(task_id)) {
+            TaskInfo_t task_info = GetTaskInfo(task_id);
+            jobs.push_back({ task_info.remaining_instructions / CoreMIPS(machine_id, task_info), task_info.priority, false, task_id });
+        }
+    }
+}
+
+double CompletionModel::CoreMIPS(MachineId_t machine_id, const TaskInfo_t & task_info) const {
+    double mips = machines.MIPS(machine_id, machines.PState(machine_id));
+    return task_info.gpu_capable && machines.HasGPU(machine_id) ? mips * GPU_SPEEDUP : mips;
+}
+
+// Play the jobs forward until the target job finishes, assuming nothing else arrives or changes.
+// Jobs at the same priority level share cores evenly, so they finish in order of the work they have
+// left; sorting once and keeping the service handed out per level makes this O(n log n).
+Time_t CompletionModel::Simulate(Time_t now, MachineId_t machine_id, bool overcommitted) const {
+    sort(jobs.begin(), jobs.end(), [](const Job & a, const Job & b) { return a.priority != b.priority ? a.priority < b.priority : a.work < b.work; });
+    size_t next[PRIORITY_LEVELS], end[PRIORITY_LEVELS];
+    double served[PRIORITY_LEVELS] = {};
+    for(unsigned level = 0, i = 0; level < PRIORITY_LEVELS; level++) {
+        next[level] = i;
+        while(i < jobs.size() && jobs[i].priority == level) {
+            i++;
+        }
+        end[level] = i;
+    }
+
+    double speed = overcommitted ? OVERCOMMIT_SPEED : 1.0;
+    double elapsed = 0;
+    while(true) {
+        // Cores go to the higher priority levels first and are shared evenly within a level
+        double rate[PRIORITY_LEVELS];
+        double cores = machines.NumCPUs(machine_id);
+        unsigned first = PRIORITY_LEVELS;
+        for(unsigned level = 0; level < PRIORITY_LEVELS; level++) {
+            double waiting = end[level] - next[level];
+            rate[level] = waiting > 0 ? speed * min(1.0, cores / waiting) : 0;
+            cores = max(0.0, cores - waiting);
+            if(rate[level] > 0 && (first == PRIORITY_LEVELS || (jobs[next[level]].work - served[level]) / rate[level]
+                                   < (jobs[next[first]].work - served[first]) / rate[first])) {
+                first = level;
+            }
+        }
+        if(first == PRIORITY_LEVELS) {
+            return now + Time_t(elapsed);
+        }
+
+        double step = max(0.0, (jobs[next[first]].work - served[first]) / rate[first]);
+        elapsed += step;
+        for(unsigned level = 0; level < PRIORITY_LEVELS; level++) {
+            served[level] += step * rate[level];
+        }
+        if(jobs[next[first]].target) {
+            return now + Time_t(elapsed);
+        }
+        next[first]++;
+    }
+}
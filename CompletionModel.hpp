@@ -0,0 +1,65 @@
+//
+//  CompletionModel.hpp
+//  CloudSim
+//
+
+#ifndef CompletionModel_hpp
+#define CompletionModel_hpp
+
+#include <vector>
+
+#include "MachineShadow.hpp"
+#include "ReverseIndex.hpp"
+#include "SimTypes.h"
+
+// Predicts when a task would finish on a machine, from the work left on the tasks already there.
+//
+// The model follows what the simulator was measured to do. A core at P-state p retires MIPS(p)
+// instructions per microsecond, twenty times that for a GPU-capable task on a GPU machine. Cores go
+// to tasks by priority: high priority tasks get a core each first, and whatever is left is shared
+// evenly among the next priority level. The hypervisor's 60 ms VM and 20 ms task time slices only
+// add jitter on top of that, so the number of VMs on a machine does not enter. A machine whose
+// memory is overcommitted runs every task at half speed.
+//
+// Each placement records its prediction, and the error against the actual completion time is kept
+// in a histogram for the end of run report.
+class CompletionModel {
+public:
+    CompletionModel(const MachineShadow & machines, const ReverseIndex & residency) : machines(machines), residency(residency) {}
+
+    void Init(unsigned num_tasks);
+    void GrowTasks(unsigned num_tasks);
+
+    // Finish time of the task if it were added to the machine now, with the given priority
+    Time_t PredictFinish(Time_t now, MachineId_t machine_id, TaskId_t task_id, Priority_t priority) const;
+
+    // Bookkeeping, fed by the scheduler once the task is on its host and when it completes
+    void TaskPlaced(Time_t now, TaskId_t task_id);
+    void TaskComplete(Time_t now, TaskId_t task_id);
+    Time_t Predicted(TaskId_t task_id) const       { return predicted[task_id]; }
+    void Report() const;
+private:
+    struct Job {
+        double work;                            // Microseconds left at a full core
+        Priority_t priority;
+        bool target;                            // The job whose finish is wanted
+        TaskId_t task_id;
+    };
+
+    void LoadJobs(MachineId_t machine_id) const;
+    double CoreMIPS(MachineId_t machine_id, const TaskInfo_t & task_info) const;
+    Time_t Simulate(Time_t now, MachineId_t machine_id, bool overcommitted) const;
+
+    const MachineShadow & machines;
+    const ReverseIndex & residency;
+
+    // Per task
+    vector<Time_t> placed_at;
+    vector<Time_t> predicted;
+
+    vector<unsigned> error_histogram;           // Relative error of completed predictions, by bin
+
+    mutable vector<Job> jobs;                   // Scratch space for Simulate
+};
+
+#endif /* CompletionModel_hpp */
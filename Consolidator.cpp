@@ -0,0 +1,164 @@
+//
+//  Consolidator.cpp
+//  CloudSim
+//
+
+#include "Consolidator.hpp"
+
+#include <algorithm>
+
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Scheduler.hpp"
+
+// Time between consolidation passes, in microseconds
+#define CONSOLIDATION_PERIOD    1000000
+// How long the simulator takes to migrate a VM, in microseconds. It does not depend on the VM's
+// memory and the tasks make no progress meanwhile. Measured against the simulator.
+#define MIGRATION_TIME          30000000
+// A machine running at most this many tasks per core is light
+#define LIGHT_LOAD              0.25
+// Passes in a row a machine has to be light before it is drained
+#define HOLD_PASSES             5
+// Migrations started per pass, across all machines
+#define MIGRATION_BUDGET        2
+// The longest task on a machine has to have this many migration times of work left for draining
+// the machine to pay off
+#define MIN_PAYOFF              3
+// A VM that was migrated stays where it is for this long after it lands, in microseconds
+#define VM_SETTLE_TIME          300000000
+// A task has to be able to finish this much ahead of its deadline, relative to its remaining
+// runtime, to be paused for a migration
+#define SLACK_MARGIN            1.25
+
+void Consolidator::Init() {
+    light_passes.assign(machines.Total(), 0);
+    planned_tasks.assign(machines.Total(), 0);
+    planned_memory.assign(machines.Total(), 0);
+}
+
+void Consolidator::PeriodicCheck(Scheduler & scheduler, Time_t now) {
+    if(now - last_pass < CONSOLIDATION_PERIOD) {
+        return;
+    }
+    last_pass = now;
+
+    sources.clear();
+    for(MachineId_t machine_id = 0; machine_id < machines.Total(); machine_id++) {
+        light_passes[machine_id] = IsLight(machine_id) ? light_passes[machine_id] + 1 : 0;
+        if(light_passes[machine_id] >= HOLD_PASSES) {
+            sources.push_back(machine_id);
+        }
+    }
+    // The lightest machines are the cheapest to drain
+    sort(sources.begin(), sources.end(), [&](MachineId_t a, MachineId_t b) { return machines.ActiveTasks(a) < machines.ActiveTasks(b); });
+
+    unsigned budget = MIGRATION_BUDGET;
+    for(MachineId_t source : sources) {
+        // Plan a home for every VM that has tasks; the machine is drained all at once or not at all
+        bool drainable = true;
+        Time_t longest = 0;
+        moves.clear();
+        for(VMId_t vm_id = residency.FirstVM(source); vm_id != NO_VM && drainable; vm_id = residency.NextVM(vm_id)) {
+            if(residency.TaskCount(vm_id) == 0) {
+                continue;
+            }
+            MachineId_t target = NO_MACHINE;
+            drainable = CanWait(now, source, vm_id, longest) && (target = Target(source, vm_id)) != NO_MACHINE;
+            if(drainable) {
+                planned_tasks[target] += residency.TaskCount(vm_id);
+                planned_memory[target] += placement.MemoryOf(vm_id);
+                moves.push_back({vm_id, target});
+            }
+        }
+        for(auto & move : moves) {
+            planned_tasks[move.second] = 0;
+            planned_memory[move.second] = 0;
+        }
+
+        if(!drainable || moves.empty() || moves.size() > budget || longest < MIN_PAYOFF * Time_t(MIGRATION_TIME)) {
+            continue;
+        }
+        LOG("Consolidator::PeriodicCheck(): Draining machine " + to_string(source) + " at time " + to_string(now), 2);
+        for(auto & move : moves) {
+            scheduler.MigrateVM(move.first, move.second);
+            if(move.first >= settled_until.size()) {
+                settled_until.resize(move.first + 1, 0);
+            }
+            settled_until[move.first] = now + MIGRATION_TIME + VM_SETTLE_TIME;
+        }
+        budget -= moves.size();
+        light_passes[source] = 0;
+        if(budget == 0) {
+            break;
+        }
+    }
+}
+
+// Up, busy with only a few tasks, and with no migration going in or out
+bool Consolidator::IsLight(MachineId_t machine_id) const {
+    unsigned tasks = machines.ActiveTasks(machine_id);
+    if(!machines.IsReady(machine_id) || tasks == 0 || tasks > LIGHT_LOAD * machines.NumCPUs(machine_id) || machines.Incoming(machine_id) != 0) {
+        return false;
+    }
+    for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+        if(placement.IsMigrating(vm_id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether the VM may be paused for a migration: it has settled since its last move and every task
+// on it keeps its SLA with the migration time added. Raises remaining to the longest runtime left.
+bool Consolidator::CanWait(Time_t now, MachineId_t machine_id, VMId_t vm_id, Time_t & remaining) const {
+    if(vm_id < settled_until.size() && now < settled_until[vm_id]) {
+        return false;
+    }
+    double mips = machines.MIPS(machine_id, P0);
+    for(TaskId_t task_id = residency.FirstTask(vm_id); task_id != NO_TASK; task_id = residency.NextTask(task_id)) {
+        TaskInfo_t task_info = GetTaskInfo(task_id);
+        Time_t runtime = Time_t(task_info.remaining_instructions / mips);
+        remaining = max(remaining, runtime);
+        if(task_info.required_sla != SLA3 && now + MIGRATION_TIME + Time_t(runtime * SLACK_MARGIN) > SLADeadline(task_info)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Most loaded compatible machine that is busier than the source and can take the VM without
+// running out of memory or cores, or NO_MACHINE
+MachineId_t Consolidator::Target(MachineId_t source, VMId_t vm_id) const {
+    // GPU work stays on GPU machines
+    bool gpu = false;
+    if(machines.HasGPU(source)) {
+        for(TaskId_t task_id = residency.FirstTask(vm_id); task_id != NO_TASK && !gpu; task_id = residency.NextTask(task_id)) {
+            gpu = IsTaskGPUCapable(task_id);
+        }
+    }
+
+    unsigned tasks = residency.TaskCount(vm_id);
+    unsigned memory = placement.MemoryOf(vm_id);
+    MachineId_t best = NO_MACHINE;
+    for(bool with_gpu : {false, true}) {
+        if(gpu && !with_gpu) {
+            continue;
+        }
+        for(auto & entry : placement.Machines(machines.CPU(source), with_gpu)) {
+            MachineId_t machine_id = entry.second;
+            unsigned load = machines.ActiveTasks(machine_id) + planned_tasks[machine_id];
+            if(machine_id == source || machines.ActiveTasks(machine_id) <= machines.ActiveTasks(source) || light_passes[machine_id] != 0
+               || machines.Incoming(machine_id) != 0 || machines.IsChanging(machine_id)) {
+                continue;
+            }
+            if(load + tasks > machines.NumCPUs(machine_id) || machines.PlaceableMemory(machine_id) < (long long) (planned_memory[machine_id] + memory)) {
+                continue;
+            }
+            if(best == NO_MACHINE || load > machines.ActiveTasks(best) + planned_tasks[best]) {
+                best = machine_id;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,55 @@
+//
+//  Consolidator.hpp
+//  CloudSim
+//
+
+#ifndef Consolidator_hpp
+#define Consolidator_hpp
+
+#include <utility>
+#include <vector>
+
+#include "MachineShadow.hpp"
+#include "PlacementIndex.hpp"
+#include "ReverseIndex.hpp"
+#include "SimTypes.h"
+
+class Scheduler;
+
+// Packs the VMs of lightly loaded machines onto busier compatible ones with live migration, so the
+// emptied machines go idle and the power manager can park them.
+//
+// Migration is expensive here: it takes about 30 seconds whatever the VM's size, and the VM's tasks
+// are paused for all of it. A machine is only drained when it has stayed light for several passes
+// in a row, when the work left on it outlasts the migration by a wide margin, and when every task
+// it hosts can lose the migration time and still meet its SLA. It is drained all at once or not at
+// all, a pass starts only a few migrations, and a VM that moved is left alone for a while after.
+class Consolidator {
+public:
+    Consolidator(const MachineShadow & machines, const PlacementIndex & placement, const ReverseIndex & residency)
+        : machines(machines), placement(placement), residency(residency) {}
+
+    void Init();
+    // Starts the migrations through Scheduler::MigrateVM
+    void PeriodicCheck(Scheduler & scheduler, Time_t now);
+private:
+    bool IsLight(MachineId_t machine_id) const;
+    bool CanWait(Time_t now, MachineId_t machine_id, VMId_t vm_id, Time_t & remaining) const;
+    MachineId_t Target(MachineId_t source, VMId_t vm_id) const;
+
+    const MachineShadow & machines;
+    const PlacementIndex & placement;
+    const ReverseIndex & residency;
+
+    Time_t last_pass = 0;
+    vector<unsigned> light_passes;              // Per machine, consecutive passes it was light
+    vector<Time_t> settled_until;               // Per VM, no migration before this time
+
+    // Scratch space for PeriodicCheck
+    vector<MachineId_t> sources;
+    vector<pair<VMId_t, MachineId_t>> moves;
+    vector<unsigned> planned_tasks;             // Per machine, tasks the current plan sends there
+    vector<unsigned> planned_memory;
+};
+
+#endif /* Consolidator_hpp */
@@ -0,0 +1,127 @@
+//
+//  DeadlineTracker.cpp
+//  CloudSim
+//
+
+#include "DeadlineTracker.hpp"
+
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Scheduler.hpp"
+
+// Shares of a task's window after which it goes back to its SLA's priority, and up to high
+#define RAISE_TO_BASE   0.5
+#define RAISE_TO_HIGH   0.75
+// Completions an SLA class needs before its compliance counts against the budget
+#define MIN_SAMPLES     20
+
+// Share of each SLA class's tasks that have to finish on time
+static const double compliance_budget[NUM_SLAS] = { 0.95, 0.90, 0.80, 0.0 };
+
+void DeadlineTracker::Init(unsigned num_tasks) {
+    GrowTasks(num_tasks);
+}
+
+void DeadlineTracker::GrowTasks(unsigned num_tasks) {
+    if(num_tasks > arrival.size()) {
+        arrival.resize(num_tasks, 0);
+        deadline.resize(num_tasks, 0);
+        base_priority.resize(num_tasks, LOW_PRIORITY);
+        priority.resize(num_tasks, LOW_PRIORITY);
+        sla.resize(num_tasks, SLA3);
+    }
+}
+
+Priority_t DeadlineTracker::Starting(Time_t now, const TaskInfo_t & task_info, Priority_t base) const {
+    return Due(now, task_info.arrival, SLADeadline(task_info), task_info.required_sla, base);
+}
+
+Priority_t DeadlineTracker::Admit(Time_t now, TaskId_t task_id, Priority_t base) {
+    TaskInfo_t task_info = GetTaskInfo(task_id);
+    arrival[task_id] = task_info.arrival;
+    deadline[task_id] = SLADeadline(task_info);
+    base_priority[task_id] = base;
+    sla[task_id] = task_info.required_sla;
+    priority[task_id] = Starting(now, task_info, base);
+    if(priority[task_id] > base) {
+        demoted++;
+    }
+    Schedule(task_id);
+    return priority[task_id];
+}
+
+void DeadlineTracker::PeriodicCheck(Time_t now) {
+    while(!steps.empty() && steps.top().first <= now) {
+        TaskId_t task_id = steps.top().second;
+        steps.pop();
+        if(residency.VMOf(task_id) == NO_VM) {
+            continue;
+        }
+        Raise(task_id, Due(now, arrival[task_id], deadline[task_id], sla[task_id], base_priority[task_id]));
+        Schedule(task_id);
+    }
+}
+
+void DeadlineTracker::SLAWarning(Time_t now, TaskId_t task_id) {
+    if(task_id < priority.size() && residency.VMOf(task_id) != NO_VM) {
+        Raise(task_id, HIGH_PRIORITY);
+    }
+}
+
+void DeadlineTracker::TaskComplete(Time_t now, TaskId_t task_id) {
+    completed[sla[task_id]]++;
+    if(now <= deadline[task_id]) {
+        on_time[sla[task_id]]++;
+    }
+}
+
+void DeadlineTracker::Report() const {
+    LOG("DeadlineTracker::Report(): " + to_string(demoted) + " tasks started below their SLA's priority, " + to_string(raised) + " raises", 1);
+    for(unsigned s = 0; s < NUM_SLAS; s++) {
+        if(completed[s] != 0) {
+            LOG("DeadlineTracker::Report(): SLA" + to_string(s) + " " + to_string(100.0 * on_time[s] / completed[s]) + "% on time, budget "
+                + to_string(100 * compliance_budget[s]) + "%", 1);
+        }
+    }
+}
+
+// The priority the task should run at by now
+Priority_t DeadlineTracker::Due(Time_t now, Time_t arrival, Time_t deadline, SLAType_t sla, Priority_t base) const {
+    if(sla == SLA3) {
+        return base;
+    }
+    double window = double(deadline - arrival);
+    double elapsed = double(now - arrival);
+    if(elapsed >= window * RAISE_TO_HIGH) {
+        return HIGH_PRIORITY;
+    }
+    if(elapsed >= window * RAISE_TO_BASE || !WithinBudget(sla)) {
+        return base;
+    }
+    return LOW_PRIORITY;
+}
+
+// Queue the task's next raise, if it has one left
+void DeadlineTracker::Schedule(TaskId_t task_id) {
+    if(sla[task_id] == SLA3 || priority[task_id] == HIGH_PRIORITY) {
+        return;
+    }
+    double window = double(deadline[task_id] - arrival[task_id]);
+    double share = priority[task_id] == base_priority[task_id] ? RAISE_TO_HIGH : RAISE_TO_BASE;
+    steps.push({ arrival[task_id] + Time_t(window * share), task_id });
+}
+
+// Priorities only ever go up once a task is placed
+void DeadlineTracker::Raise(TaskId_t task_id, Priority_t target) {
+    if(target >= priority[task_id]) {
+        return;
+    }
+    LOG("DeadlineTracker::Raise(): Task " + to_string(task_id) + " to priority " + to_string(target), 4);
+    SetTaskPriority(task_id, target);
+    priority[task_id] = target;
+    raised++;
+}
+
+bool DeadlineTracker::WithinBudget(SLAType_t sla) const {
+    return completed[sla] < MIN_SAMPLES || on_time[sla] >= compliance_budget[sla] * completed[sla];
+}
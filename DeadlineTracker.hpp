@@ -0,0 +1,67 @@
+//
+//  DeadlineTracker.hpp
+//  CloudSim
+//
+
+#ifndef DeadlineTracker_hpp
+#define DeadlineTracker_hpp
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "ReverseIndex.hpp"
+#include "SimTypes.h"
+
+// Moves task priorities with their deadlines instead of fixing them by SLA at arrival.
+//
+// The simulator hands cores out by priority: high priority tasks get a core each first and the
+// rest share what is left. A task whose SLA class is within its compliance budget (95% of SLA0
+// tasks on time, 90% of SLA1, 80% of SLA2) starts at low priority, leaving the cores to more urgent
+// work. Halfway through its window, from arrival to deadline, it goes back to its SLA's priority,
+// and three quarters of the way through, or on an SLAWarning, to high. A class that falls behind its
+// budget starts at its SLA's priority. SLA3 has no deadline to meet and stays where it is.
+//
+// Tasks wait for their next step in a min-heap by the time it is due, so a check only touches the
+// tasks whose step has come. Completed tasks are dropped from the heap lazily.
+class DeadlineTracker {
+public:
+    DeadlineTracker(const ReverseIndex & residency) : residency(residency) {}
+
+    void Init(unsigned num_tasks);
+    void GrowTasks(unsigned num_tasks);
+
+    // Priority a task placed now starts at, given the one its SLA calls for
+    Priority_t Starting(Time_t now, const TaskInfo_t & task_info, Priority_t base) const;
+    // Priority to place the task with; starts tracking it
+    Priority_t Admit(Time_t now, TaskId_t task_id, Priority_t base);
+    void PeriodicCheck(Time_t now);
+    void SLAWarning(Time_t now, TaskId_t task_id);
+    void TaskComplete(Time_t now, TaskId_t task_id);
+    void Report() const;
+private:
+    Priority_t Due(Time_t now, Time_t arrival, Time_t deadline, SLAType_t sla, Priority_t base) const;
+    void Schedule(TaskId_t task_id);
+    void Raise(TaskId_t task_id, Priority_t priority);
+    bool WithinBudget(SLAType_t sla) const;
+
+    const ReverseIndex & residency;
+
+    // Per task
+    vector<Time_t> arrival;
+    vector<Time_t> deadline;
+    vector<Priority_t> base_priority;
+    vector<Priority_t> priority;
+    vector<SLAType_t> sla;
+
+    priority_queue<pair<Time_t, TaskId_t>, vector<pair<Time_t, TaskId_t>>, greater<pair<Time_t, TaskId_t>>> steps;
+
+    // Per SLA
+    unsigned completed[NUM_SLAS] = {};
+    unsigned on_time[NUM_SLAS] = {};
+    unsigned demoted = 0;
+    unsigned raised = 0;
+};
+
+#endif /* DeadlineTracker_hpp */
@@ -0,0 +1,566 @@
+//
+//  FakeSimulator.cpp
+//  CloudSim
+//
+
+#include "FakeSimulator.hpp"
+
+#include <algorithm>
+#include <queue>
+
+#include "Interfaces.h"
+#include "Internal_Interfaces.h"
+#include "Scheduler.hpp"
+
+// What the measured simulator does by default: checks every 60 ms, migrations take 30 s
+#define CHECK_PERIOD    60000
+#define MIGRATION_TIME  30000000
+// Speedup of a GPU-capable task on a GPU machine
+#define GPU_SPEEDUP     20
+
+struct FakeVM {
+    VMInfo_t info;
+    bool attached;
+    bool migrating;
+    Time_t migration_start;
+    Time_t migration_end;
+};
+
+enum FakeUpcall_t {
+    FAKE_NEW_TASK,
+    FAKE_TASK_COMPLETION,
+    FAKE_MEMORY_WARNING,
+    FAKE_SLA_WARNING,
+    FAKE_STATE_CHANGE,
+    FAKE_MIGRATION,
+    FAKE_CHECK
+};
+
+struct FakeEvent {
+    Time_t time;
+    uint64_t sequence;
+    FakeUpcall_t upcall;
+    unsigned id;                                // Task, machine or VM, as fits the upcall
+    unsigned arg;                               // S-state or migration target
+
+    bool operator>(const FakeEvent & other) const {
+        return time != other.time ? time > other.time : sequence > other.sequence;
+    }
+};
+
+static vector<MachineInfo_t> machines;
+static vector<FakeVM> vms;
+static vector<TaskInfo_t> tasks;
+static Time_t now = 0;
+
+static priority_queue<FakeEvent, vector<FakeEvent>, greater<FakeEvent>> events;
+static uint64_t sequence = 0;
+static unsigned scripted = 0;                   // Queued events other than checks
+static bool check_queued = false;
+static Time_t check_period = CHECK_PERIOD;
+static Time_t state_change_latency = 0;
+static Time_t migration_time = MIGRATION_TIME;
+static bool auto_complete = false;
+static Scheduler * attached = nullptr;
+
+static void Queue(Time_t time, FakeUpcall_t upcall, unsigned id, unsigned arg = 0) {
+    events.push({ time, sequence++, upcall, id, arg });
+    if(upcall != FAKE_CHECK) {
+        scripted++;
+    }
+}
+
+static VMId_t VMOfTask(TaskId_t task_id) {
+    VMId_t vm_id = 0;
+    for(; vm_id < vms.size(); vm_id++) {
+        const vector<TaskId_t> & active = vms[vm_id].info.active_tasks;
+        if(find(active.begin(), active.end(), task_id) != active.end()) {
+            break;
+        }
+    }
+    return vm_id;
+}
+
+// The source already gave up the VM when it set off (see VM_Migrate()); the whole VM lands on the
+// target. Like the simulator, the source is never given back the memory of the tasks that left.
+static void MoveVM(VMId_t vm_id, MachineId_t machine_id) {
+    FakeVM & vm = vms[vm_id];
+    MachineInfo_t & target = machines.at(machine_id);
+    unsigned memory = VM_MEMORY_OVERHEAD;
+    for(TaskId_t task_id : vm.info.active_tasks) {
+        memory += tasks[task_id].required_memory;
+    }
+    target.active_vms++;
+    target.active_tasks += unsigned(vm.info.active_tasks.size());
+    target.memory_used += memory;
+    vm.info.machine_id = machine_id;
+    vm.migrating = false;
+}
+
+static void Deliver(const FakeEvent & event) {
+    now = event.time;
+    switch(event.upcall) {
+        case FAKE_NEW_TASK:
+            if(attached != nullptr) {
+                attached->NewTask(now, event.id);
+            }
+            else {
+                HandleNewTask(now, event.id);
+            }
+            break;
+        case FAKE_TASK_COMPLETION: {
+            // Tasks stop while their VM migrates, so the completion slips by the time they lost
+            VMId_t vm_id = VMOfTask(event.id);
+            if(vm_id < vms.size() && vms[vm_id].migrating) {
+                Queue(vms[vm_id].migration_end + now - vms[vm_id].migration_start, FAKE_TASK_COMPLETION, event.id);
+                break;
+            }
+            // A scripted completion and an automatic one may both be queued
+            if(!tasks[event.id].completed) {
+                FakeSimulator::CompleteTask(event.id);
+                if(attached != nullptr) {
+                    attached->TaskComplete(now, event.id);
+                }
+                else {
+                    HandleTaskCompletion(now, event.id);
+                }
+            }
+            break;
+        }
+        case FAKE_MEMORY_WARNING:
+            if(attached != nullptr) {
+                attached->MemoryWarning(now, event.id);
+            }
+            else {
+                MemoryWarning(now, event.id);
+            }
+            break;
+        case FAKE_SLA_WARNING:
+            if(attached != nullptr) {
+                attached->SLAWarning(now, event.id);
+            }
+            else {
+                SLAWarning(now, event.id);
+            }
+            break;
+        case FAKE_STATE_CHANGE:
+            machines[event.id].s_state = MachineState_t(event.arg);
+            if(attached != nullptr) {
+                attached->StateChangeComplete(now, event.id);
+            }
+            else {
+                StateChangeComplete(now, event.id);
+            }
+            break;
+        case FAKE_MIGRATION:
+            MoveVM(event.id, event.arg);
+            if(attached != nullptr) {
+                attached->MigrationComplete(now, event.id);
+            }
+            else {
+                MigrationDone(now, event.id);
+            }
+            break;
+        case FAKE_CHECK:
+            check_queued = false;
+            if(attached != nullptr) {
+                attached->PeriodicCheck(now);
+            }
+            else {
+                SchedulerCheck(now);
+            }
+            break;
+    }
+}
+
+static void QueueCheck() {
+    if(check_period != 0 && !check_queued) {
+        Queue(now + check_period, FAKE_CHECK, 0);
+        check_queued = true;
+    }
+}
+
+namespace FakeSimulator {
+    void Reset() {
+        machines.clear();
+        vms.clear();
+        tasks.clear();
+        now = 0;
+        events = {};
+        sequence = 0;
+        scripted = 0;
+        check_queued = false;
+        check_period = CHECK_PERIOD;
+        state_change_latency = 0;
+        migration_time = MIGRATION_TIME;
+        auto_complete = false;
+        attached = nullptr;
+    }
+
+    void Attach(Scheduler * scheduler) {
+        attached = scheduler;
+    }
+
+    MachineId_t AddMachine(CPUType_t cpu, unsigned num_cpus, unsigned memory, bool gpu) {
+        MachineInfo_t info = {};
+        info.num_cpus = num_cpus;
+        info.cpu = cpu;
+        info.memory_size = memory;
+        info.gpus = gpu;
+        info.performance = { 3000, 2400, 2000, 1500 };
+        info.c_states = { 12, 3, 1, 0 };
+        info.p_states = { 12, 8, 6, 4 };
+        info.s_states = { 120, 100, 100, 80, 40, 10, 0 };
+        info.s_state = S0;
+        info.p_state = P0;
+        info.machine_id = MachineId_t(machines.size());
+        machines.push_back(info);
+        return info.machine_id;
+    }
+
+    void SetStatePower(MachineId_t machine_id, MachineState_t s_state, unsigned power) {
+        machines.at(machine_id).s_states.at(s_state) = power;
+    }
+
+    TaskId_t AddTask(Time_t arrival, uint64_t instructions, Time_t deadline, VMType_t vm_type, SLAType_t sla,
+                     CPUType_t cpu, bool gpu, unsigned memory) {
+        TaskInfo_t info = {};
+        info.total_instructions = instructions;
+        info.remaining_instructions = instructions;
+        info.arrival = arrival;
+        info.target_completion = deadline;
+        info.gpu_capable = gpu;
+        info.priority = MID_PRIORITY;
+        info.required_cpu = cpu;
+        info.required_memory = memory;
+        info.required_sla = sla;
+        info.required_vm = vm_type;
+        info.task_id = TaskId_t(tasks.size());
+        tasks.push_back(info);
+        return info.task_id;
+    }
+
+    void SetCheckPeriod(Time_t period) {
+        check_period = period;
+    }
+
+    void SetStateChangeLatency(Time_t latency) {
+        state_change_latency = latency;
+    }
+
+    void SetMigrationTime(Time_t duration) {
+        migration_time = duration;
+    }
+
+    void SetAutoComplete(bool on) {
+        auto_complete = on;
+    }
+
+    void InjectArrivals() {
+        for(const TaskInfo_t & task : tasks) {
+            Queue(task.arrival, FAKE_NEW_TASK, task.task_id);
+        }
+    }
+
+    void InjectNewTask(Time_t time, TaskId_t task_id) {
+        Queue(time, FAKE_NEW_TASK, task_id);
+    }
+
+    void InjectTaskCompletion(Time_t time, TaskId_t task_id) {
+        Queue(time, FAKE_TASK_COMPLETION, task_id);
+    }
+
+    void InjectMemoryWarning(Time_t time, MachineId_t machine_id) {
+        Queue(time, FAKE_MEMORY_WARNING, machine_id);
+    }
+
+    void InjectSLAWarning(Time_t time, TaskId_t task_id) {
+        Queue(time, FAKE_SLA_WARNING, task_id);
+    }
+
+    void Advance(Time_t until) {
+        QueueCheck();
+        while(!events.empty() && events.top().time <= until) {
+            FakeEvent event = events.top();
+            events.pop();
+            if(event.upcall != FAKE_CHECK) {
+                scripted--;
+            }
+            Deliver(event);
+            QueueCheck();
+        }
+        now = max(now, until);
+    }
+
+    void Run() {
+        QueueCheck();
+        while(scripted != 0) {
+            Advance(events.top().time);
+        }
+        if(attached != nullptr) {
+            attached->Shutdown(now);
+        }
+        else {
+            SimulationComplete(now);
+        }
+    }
+
+    void SetNow(Time_t time) {
+        now = time;
+    }
+
+    void CompleteTask(TaskId_t task_id) {
+        TaskInfo_t & task = tasks[task_id];
+        VMId_t vm_id = VMOfTask(task_id);
+        if(vm_id < vms.size()) {
+            VM_RemoveTask(vm_id, task_id);
+        }
+        task.completed = true;
+        task.completion = now;
+        task.remaining_instructions = 0;
+    }
+}
+
+// The parts of the simulator's internal interface the scheduler uses
+
+// The simulator's AddTask() queues the arrival itself
+TaskId_t AddTask(uint64_t inst, Time_t arr, Time_t trgt, VMType_t vm, SLAType_t sla, CPUType_t cpu, bool gpu, unsigned mem, TaskClass_t task_class) {
+    TaskId_t task_id = FakeSimulator::AddTask(arr, inst, trgt, vm, sla, cpu, gpu, mem);
+    FakeSimulator::InjectNewTask(arr, task_id);
+    return task_id;
+}
+
+void ScheduleNewTask(Time_t time, TaskId_t task_id) {
+    FakeSimulator::InjectNewTask(time, task_id);
+}
+
+// Debugging Interface
+
+void SimOutput(string msg, unsigned verbose_level) {
+    if(verbose_level == 0) {
+        cout << msg << endl;
+    }
+}
+
+void ThrowException(string err_msg) {
+    throw runtime_error(err_msg);
+}
+
+void ThrowException(string err_msg, string further_input) {
+    throw runtime_error(err_msg + further_input);
+}
+
+void ThrowException(string err_msg, unsigned further_input) {
+    throw runtime_error(err_msg + to_string(further_input));
+}
+
+// Machine Interface
+
+CPUType_t Machine_GetCPUType(MachineId_t machine_id) {
+    return machines.at(machine_id).cpu;
+}
+
+uint64_t Machine_GetEnergy(MachineId_t machine_id) {
+    return machines.at(machine_id).energy_consumed;
+}
+
+double Machine_GetClusterEnergy() {
+    return 0;
+}
+
+MachineInfo_t Machine_GetInfo(MachineId_t machine_id) {
+    return machines.at(machine_id);
+}
+
+unsigned Machine_GetTotal() {
+    return unsigned(machines.size());
+}
+
+void Machine_SetCorePerformance(MachineId_t machine_id, unsigned core_id, CPUPerformance_t p_state) {
+    machines.at(machine_id).p_state = p_state;
+}
+
+void Machine_SetState(MachineId_t machine_id, MachineState_t s_state) {
+    if(machine_id >= machines.size()) {
+        ThrowException("Machine_SetState(): No machine ", machine_id);
+    }
+    Queue(now + state_change_latency, FAKE_STATE_CHANGE, machine_id, s_state);
+}
+
+// Statistics
+
+double GetSLAReport(SLAType_t sla) {
+    unsigned completed = 0, violated = 0;
+    for(const TaskInfo_t & task : tasks) {
+        if(task.completed && task.required_sla == sla) {
+            completed++;
+            violated += task.completion > task.target_completion;
+        }
+    }
+    return completed != 0 ? 100.0 * violated / completed : 0;
+}
+
+// Simulator Interface
+
+Time_t Now() {
+    return now;
+}
+
+// Task Interface
+
+unsigned GetNumTasks() {
+    return unsigned(tasks.size());
+}
+
+TaskInfo_t GetTaskInfo(TaskId_t task_id) {
+    return tasks.at(task_id);
+}
+
+unsigned GetTaskMemory(TaskId_t task_id) {
+    return tasks.at(task_id).required_memory;
+}
+
+unsigned GetTaskPriority(TaskId_t task_id) {
+    return tasks.at(task_id).priority;
+}
+
+bool IsSLAViolated(TaskId_t task_id) {
+    const TaskInfo_t & task = tasks.at(task_id);
+    return (task.completed ? task.completion : now) > task.target_completion;
+}
+
+bool IsTaskCompleted(TaskId_t task_id) {
+    return tasks.at(task_id).completed;
+}
+
+bool IsTaskGPUCapable(TaskId_t task_id) {
+    return tasks.at(task_id).gpu_capable;
+}
+
+CPUType_t RequiredCPUType(TaskId_t task_id) {
+    return tasks.at(task_id).required_cpu;
+}
+
+SLAType_t RequiredSLA(TaskId_t task_id) {
+    return tasks.at(task_id).required_sla;
+}
+
+VMType_t RequiredVMType(TaskId_t task_id) {
+    return tasks.at(task_id).required_vm;
+}
+
+void SetTaskPriority(TaskId_t task_id, Priority_t priority) {
+    tasks.at(task_id).priority = priority;
+}
+
+// VM Interface
+//
+// Calls the simulator rejects throw here too, with its messages. It accepts a task for a VM on a
+// sleeping machine, so that is not checked.
+
+void VM_Attach(VMId_t vm_id, MachineId_t machine_id) {
+    FakeVM & vm = vms.at(vm_id);
+    MachineInfo_t & machine = machines.at(machine_id);
+    if(vm.attached) {
+        ThrowException("VM::Attach(): Attaching a VM to a machine while the VM is already running");
+    }
+    if(machine.cpu != vm.info.cpu) {
+        ThrowException("VM::Attach(): Attaching a VM to a machine with incompatible CPU");
+    }
+    if(machine.s_state != S0) {
+        ThrowException("Machine::AttachVM(): Attempt at attaching virtual machine while in sleep mode ", vm_id);
+    }
+    vm.info.machine_id = machine_id;
+    vm.attached = true;
+    machine.active_vms++;
+    machine.memory_used += VM_MEMORY_OVERHEAD;
+}
+
+void VM_AddTask(VMId_t vm_id, TaskId_t task_id, Priority_t priority) {
+    FakeVM & vm = vms.at(vm_id);
+    if(!vm.attached || vm.migrating) {
+        ThrowException("VM::AddTask(): Adding a task to a VM that is not ready (either not allocated to a machine or migrating");
+    }
+    TaskInfo_t & task = tasks.at(task_id);
+    if(task.required_cpu != vm.info.cpu) {
+        ThrowException("VM::AddTask(): Adding a task to a VM with incompatible CPU");
+    }
+    MachineInfo_t & machine = machines[vm.info.machine_id];
+    task.priority = priority;
+    vm.info.active_tasks.push_back(task_id);
+    machine.active_tasks++;
+    machine.memory_used += task.required_memory;
+    if(auto_complete) {
+        uint64_t mips = uint64_t(machine.performance[machine.p_state]) * (task.gpu_capable && machine.gpus ? GPU_SPEEDUP : 1);
+        Queue(now + task.remaining_instructions / max<uint64_t>(mips, 1), FAKE_TASK_COMPLETION, task_id);
+    }
+}
+
+VMId_t VM_Create(VMType_t vm_type, CPUType_t cpu) {
+    FakeVM vm = {};
+    vm.info.cpu = cpu;
+    vm.info.vm_type = vm_type;
+    vm.info.vm_id = VMId_t(vms.size());
+    vm.info.machine_id = MachineId_t(-1);
+    vms.push_back(vm);
+    return vm.info.vm_id;
+}
+
+VMInfo_t VM_GetInfo(VMId_t vm_id) {
+    return vms.at(vm_id).info;
+}
+
+void VM_Migrate(VMId_t vm_id, MachineId_t machine_id) {
+    FakeVM & vm = vms.at(vm_id);
+    if(!vm.attached || vm.migrating || vm.info.machine_id == machine_id) {
+        ThrowException("VM::Migrate(): Incorrect VM migration request");
+    }
+    MachineInfo_t & target = machines.at(machine_id);
+    if(target.cpu != vm.info.cpu) {
+        ThrowException("VM::Migrate(): Attaching a VM to a machine with incompatible CPU");
+    }
+    if(target.s_state != S0) {
+        ThrowException("MigrateVM(): Trying to migrate VM while the machine is in sleep mode ", vm_id);
+    }
+    // The source drops the VM and its tasks at once but keeps charging for the tasks' memory
+    MachineInfo_t & source = machines[vm.info.machine_id];
+    source.active_vms--;
+    source.active_tasks -= unsigned(vm.info.active_tasks.size());
+    source.memory_used -= VM_MEMORY_OVERHEAD;
+    vm.migrating = true;
+    vm.migration_start = now;
+    vm.migration_end = now + migration_time;
+    Queue(vm.migration_end, FAKE_MIGRATION, vm_id, machine_id);
+}
+
+void VM_RemoveTask(VMId_t vm_id, TaskId_t task_id) {
+    FakeVM & vm = vms.at(vm_id);
+    vector<TaskId_t> & active = vm.info.active_tasks;
+    if(!vm.attached || vm.migrating) {
+        ThrowException("VM::RemoveTask(): Removing a task from an inactive or migrating VM");
+    }
+    auto it = find(active.begin(), active.end(), task_id);
+    if(it == active.end()) {
+        ThrowException("VM::RemoveTask(): VM is asked to remove a non existent task");
+    }
+    active.erase(it);
+    MachineInfo_t & machine = machines[vm.info.machine_id];
+    machine.active_tasks--;
+    machine.memory_used -= tasks[task_id].required_memory;
+}
+
+void VM_Shutdown(VMId_t vm_id) {
+    FakeVM & vm = vms.at(vm_id);
+    if(!vm.attached || vm.migrating) {
+        ThrowException("VM::Shutdown(): Shutting down an inactive VM");
+    }
+    MachineInfo_t & machine = machines[vm.info.machine_id];
+    for(TaskId_t task_id : vm.info.active_tasks) {
+        machine.active_tasks--;
+        machine.memory_used -= tasks[task_id].required_memory;
+    }
+    vm.info.active_tasks.clear();
+    machine.active_vms--;
+    machine.memory_used -= VM_MEMORY_OVERHEAD;
+    vm.attached = false;
+}
@@ -0,0 +1,77 @@
+//
+//  FakeSimulator.hpp
+//  CloudSim
+//
+
+#ifndef FakeSimulator_hpp
+#define FakeSimulator_hpp
+
+#include "SimTypes.h"
+
+// In-process stand-in for the simulator's side of Interfaces.h, for driving the scheduler without
+// linking the prebuilt simulator objects. It keeps just enough state for the down-calls to answer
+// like the real thing: machines with their specs, memory and task counts, VMs and where they live,
+// and tasks with their requirements.
+//
+// Time only moves when the caller says so. Upcalls are queued with a time and delivered in time
+// order by Advance(), ties in the order they were queued; the clock Now() reports is the time of
+// the upcall being delivered. Besides the scripted ones, the fake queues what the simulator would:
+// StateChangeComplete() a set latency after Machine_SetState(), MigrationDone() a set time after
+// VM_Migrate(), and SchedulerCheck() every check period. With auto completion on, a task also
+// completes on its own after running its instructions at its host's speed; there is no contention
+// and no energy model, so that is for exercising control flow, not for judging policies.
+//
+// Down-calls the simulator rejects throw, with its messages. Migrations follow its accounting: the
+// VM's tasks stop and leave the source when it sets off, the source keeps charging for their memory
+// for good, and the whole VM is charged to the target when it lands.
+//
+// Typical use:
+//     FakeSimulator::AddMachine(X86, 8, 16384, false);            // the cluster
+//     FakeSimulator::AddTask(...);                                // and the workload
+//     InitScheduler();
+//     FakeSimulator::InjectArrivals();
+//     FakeSimulator::InjectMemoryWarning(5000000, 0);
+//     FakeSimulator::Run();                                       // ends with SimulationComplete()
+//
+// Upcalls go through the entry points in Scheduler.cpp, to the scheduler InitScheduler() set up.
+// Attach() sends them straight to a scheduler of the caller's instead, so every scenario can start
+// from a fresh one (Tests.cpp).
+class Scheduler;
+
+namespace FakeSimulator {
+    // Also detaches the scheduler
+    void Reset();
+    void Attach(Scheduler * scheduler);
+
+    // Power and MIPS tables are those of the first machine class in Input.md
+    MachineId_t AddMachine(CPUType_t cpu, unsigned num_cpus, unsigned memory, bool gpu);
+    // Overrides one entry of the machine's S-state power table, before the scheduler reads it
+    void SetStatePower(MachineId_t machine_id, MachineState_t s_state, unsigned power);
+    TaskId_t AddTask(Time_t arrival, uint64_t instructions, Time_t deadline, VMType_t vm_type, SLAType_t sla,
+                     CPUType_t cpu, bool gpu, unsigned memory);
+
+    // Timing of the upcalls the fake generates itself. A check period of 0 turns the checks off.
+    void SetCheckPeriod(Time_t period);
+    void SetStateChangeLatency(Time_t latency);
+    void SetMigrationTime(Time_t duration);
+    void SetAutoComplete(bool on);
+
+    // Scripted upcalls
+    void InjectArrivals();                      // HandleNewTask() for every task at its arrival
+    void InjectNewTask(Time_t time, TaskId_t task_id);
+    void InjectTaskCompletion(Time_t time, TaskId_t task_id);
+    void InjectMemoryWarning(Time_t time, MachineId_t machine_id);
+    void InjectSLAWarning(Time_t time, TaskId_t task_id);
+
+    // Delivers every upcall due up to the given time and leaves the clock there
+    void Advance(Time_t until);
+    // Delivers upcalls until only scheduler checks are left, then SimulationComplete(), or Shutdown()
+    // on the attached scheduler
+    void Run();
+
+    void SetNow(Time_t now);
+    // Marks the task done, as the simulator does right before HandleTaskCompletion()
+    void CompleteTask(TaskId_t task_id);
+}
+
+#endif /* FakeSimulator_hpp */
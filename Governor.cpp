@@ -0,0 +1,125 @@
+//
+//  Governor.cpp
+//  CloudSim
+//
+
+#include "Governor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Interfaces.h"
+#include "Scheduler.hpp"
+#include "Trace.hpp"
+
+// A task has to be able to finish this much ahead of its deadline, relative to its remaining
+// runtime, to count as having slack
+#define SLACK_MARGIN    1.25
+// How long a machine stays at P0 after an SLA warning or an arrival burst, in microseconds
+#define BOOST_HOLD      1000000
+
+void Governor::Init() {
+    unsigned total = machines.Total();
+    time_in_p_state.assign(total * P_STATES, 0);
+    last_settled.assign(total, 0);
+    boosted_until.assign(total, 0);
+    arrivals.assign(total, 0);
+}
+
+void Governor::PeriodicCheck(Time_t now) {
+    for(MachineId_t machine_id = 0; machine_id < machines.Total(); machine_id++) {
+        Settle(now, machine_id);
+        arrivals[machine_id] = 0;
+        if(!machines.IsReady(machine_id) || machines.ActiveTasks(machine_id) == 0 || now < boosted_until[machine_id]) {
+            continue;
+        }
+        CPUPerformance_t p_state = Pick(now, machine_id);
+        if(p_state != machines.PState(machine_id)) {
+            Set(now, machine_id, p_state);
+        }
+    }
+}
+
+void Governor::TaskPlaced(Time_t now, MachineId_t machine_id) {
+    // More arrivals in one check period than the machine has cores is a burst
+    if(++arrivals[machine_id] > machines.NumCPUs(machine_id)) {
+        Boost(now, machine_id);
+    }
+}
+
+void Governor::SLAWarning(Time_t now, MachineId_t machine_id) {
+    if(machines.IsReady(machine_id)) {
+        Boost(now, machine_id);
+    }
+}
+
+// Cheapest P-state per instruction at which every task with a deadline still ahead can meet it,
+// or P0 if none can
+CPUPerformance_t Governor::Pick(Time_t now, MachineId_t machine_id) const {
+    // Energy per instruction of the whole machine: its S0 draw plus the busy cores at p and the rest
+    // idling in C1, over the MIPS the busy cores deliver
+    unsigned cpus = machines.NumCPUs(machine_id);
+    unsigned busy = min(cpus, machines.ActiveTasks(machine_id));
+    double energy[P_STATES];
+    CPUPerformance_t cheapest = P0;
+    for(CPUPerformance_t p_state : { P0, P1, P2, P3 }) {
+        double power = machines.StatePower(machine_id, S0) + double(busy) * machines.CorePower(machine_id, p_state)
+                     + double(cpus - busy) * machines.IdleCorePower(machine_id, C1);
+        double mips = machines.MIPS(machine_id, p_state);
+        energy[p_state] = mips > 0 ? power / (busy * mips) : HUGE_VAL;
+        if(energy[p_state] < energy[cheapest]) {
+            cheapest = p_state;
+        }
+    }
+    // Racing to idle is cheapest, no need to look at the tasks. An overcommitted machine stays at P0
+    // too: its tasks share cores by priority, so a task's speed can no longer be read off the clock.
+    if(cheapest == P0 || machines.ActiveTasks(machine_id) > cpus) {
+        return P0;
+    }
+
+    double needed_mips = 0;
+    for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+        for(TaskId_t task_id = residency.FirstTask(vm_id); task_id != NO_TASK; task_id = residency.NextTask(task_id)) {
+            TaskInfo_t task_info = GetTaskInfo(task_id);
+            Time_t deadline = SLADeadline(task_info);
+            // Best effort tasks have no deadline, and a missed deadline cannot be saved by running faster
+            if(task_info.required_sla == SLA3 || deadline <= now) {
+                continue;
+            }
+            needed_mips = max(needed_mips, task_info.remaining_instructions * SLACK_MARGIN / (deadline - now));
+        }
+    }
+
+    // Every task has a core to itself, so it runs at the full clock
+    CPUPerformance_t best = P0;
+    for(CPUPerformance_t p_state : { P1, P2, P3 }) {
+        if(machines.MIPS(machine_id, p_state) >= needed_mips && energy[p_state] < energy[best]) {
+            best = p_state;
+        }
+    }
+    return best;
+}
+
+void Governor::Boost(Time_t now, MachineId_t machine_id) {
+    boosted_until[machine_id] = now + BOOST_HOLD;
+    if(machines.PState(machine_id) != P0) {
+        Set(now, machine_id, P0);
+    }
+}
+
+void Governor::Set(Time_t now, MachineId_t machine_id, CPUPerformance_t p_state) {
+    Settle(now, machine_id);
+    Machine_SetCorePerformance(machine_id, 0, p_state);
+    Trace(TRACE_P_STATE, NO_TASK, NO_VM, machine_id, p_state);
+    machines.SetPState(machine_id, p_state);
+    // Available MIPS moved with the clock, so re-sort the machine
+    placement.Update(machine_id);
+}
+
+// Charge the time since the last settlement to the machine's current P-state
+void Governor::Settle(Time_t now, MachineId_t machine_id) {
+    if(machines.IsReady(machine_id)) {
+        time_in_p_state[machine_id * P_STATES + machines.PState(machine_id)] += now - last_settled[machine_id];
+    }
+    last_settled[machine_id] = now;
+}
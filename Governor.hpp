@@ -0,0 +1,53 @@
+//
+//  Governor.hpp
+//  CloudSim
+//
+
+#ifndef Governor_hpp
+#define Governor_hpp
+
+#include <vector>
+
+#include "MachineShadow.hpp"
+#include "PlacementIndex.hpp"
+#include "ReverseIndex.hpp"
+#include "SimTypes.h"
+
+// Per-machine DVFS governor. Every check it runs each awake machine at the P-state with the lowest
+// energy per instruction that still leaves the tightest task on it positive SLA slack. Energy per
+// instruction counts the whole machine, so a machine whose S0 draw dwarfs its cores is better off
+// racing to idle at P0, while one with cheap idle power and hungry cores is clocked down.
+//
+// An SLA warning or a burst of arrivals on a machine pushes it to P0 right away and holds it there
+// for a while. Time spent at each P-state is counted per machine.
+class Governor {
+public:
+    Governor(MachineShadow & machines, PlacementIndex & placement, const ReverseIndex & residency)
+        : machines(machines), placement(placement), residency(residency) {}
+
+    void Init();
+    void PeriodicCheck(Time_t now);
+    // A task was just placed on the machine
+    void TaskPlaced(Time_t now, MachineId_t machine_id);
+    void SLAWarning(Time_t now, MachineId_t machine_id);
+
+    // Time the machine has spent awake at the P-state, as of the last check
+    Time_t TimeInPState(MachineId_t machine_id, CPUPerformance_t p_state) const { return time_in_p_state[machine_id * P_STATES + p_state]; }
+private:
+    CPUPerformance_t Pick(Time_t now, MachineId_t machine_id) const;
+    void Boost(Time_t now, MachineId_t machine_id);
+    void Set(Time_t now, MachineId_t machine_id, CPUPerformance_t p_state);
+    void Settle(Time_t now, MachineId_t machine_id);
+
+    MachineShadow & machines;
+    PlacementIndex & placement;
+    const ReverseIndex & residency;
+
+    // Per machine
+    vector<Time_t> time_in_p_state;             // P_STATES entries per machine
+    vector<Time_t> last_settled;
+    vector<Time_t> boosted_until;
+    vector<unsigned> arrivals;                  // Since the last check
+};
+
+#endif /* Governor_hpp */
@@ -0,0 +1,84 @@
+//
+//  Log.cpp
+//  CloudSim
+//
+
+#include "Log.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+// Environment variable with the highest message level to build, normally the -v level
+#define LOG_LEVEL_VARIABLE  "CLOUDSIM_LOG_LEVEL"
+// Environment variable naming the file the audit trail is written to
+#define AUDIT_VARIABLE  "CLOUDSIM_AUDIT"
+// Records kept, the most recent ones win; 16 MB
+#define AUDIT_CAPACITY  (1 << 20)
+
+static_assert(sizeof(AuditRecord_t) == 16, "audit records are written to disk as is");
+
+// The simulator keeps its verbosity to itself, so the level to build messages for comes from the
+// environment. Unset, every message is built and SimOutput() filters by -v as usual.
+static unsigned ReadLogLevel() {
+    const char * value = getenv(LOG_LEVEL_VARIABLE);
+    if(value == nullptr || *value == '\0') {
+        return UINT_MAX;
+    }
+    return unsigned(atoi(value));
+}
+
+static unsigned log_level = ReadLogLevel();
+
+unsigned LogLevel() {
+    return log_level;
+}
+
+void SetLogLevel(unsigned level) {
+    log_level = level;
+}
+
+namespace AuditTrail {
+    bool enabled = false;
+
+    static string path;
+    static vector<AuditRecord_t> ring;
+    static uint64_t appended = 0;
+
+    void Init() {
+        const char * audit_path = getenv(AUDIT_VARIABLE);
+        if(audit_path == nullptr || *audit_path == '\0') {
+            return;
+        }
+        path = audit_path;
+        ring.resize(AUDIT_CAPACITY);
+        appended = 0;
+        enabled = true;
+    }
+
+    void Append(AuditEvent_t event, Time_t time, uint32_t id) {
+        ring[appended++ % AUDIT_CAPACITY] = { time, event, id };
+    }
+
+    void Write() {
+        if(!enabled) {
+            return;
+        }
+        ofstream out(path, ios::binary | ios::trunc);
+        if(!out) {
+            SimOutput("AuditTrail::Write(): Cannot open " + path, 0);
+            return;
+        }
+        uint64_t count = min<uint64_t>(appended, AUDIT_CAPACITY);
+        out.write("CSAUDIT1", 8);
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        // Oldest first: once the ring has wrapped the oldest record sits right after the newest
+        uint64_t first = appended - count;
+        for(uint64_t i = first; i < appended; i++) {
+            out.write(reinterpret_cast<const char *>(&ring[i % AUDIT_CAPACITY]), sizeof(AuditRecord_t));
+        }
+        SimOutput("AuditTrail::Write(): " + to_string(count) + " of " + to_string(appended) + " upcalls written to " + path, 1);
+    }
+}
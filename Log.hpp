@@ -0,0 +1,73 @@
+//
+//  Log.hpp
+//  CloudSim
+//
+
+#ifndef Log_hpp
+#define Log_hpp
+
+#include <cstdint>
+
+#include "Interfaces.h"
+#include "SimTypes.h"
+
+// Front end to SimOutput() that only builds the message when it would be printed. SimOutput() takes
+// a ready made string, so every call pays for the to_string()s and concatenations even when the
+// verbosity filters the message out; LOG() checks the level first and never evaluates the message
+// otherwise:
+//     LOG("Scheduler::NewTask(): Task " + to_string(task_id) + " queued", 3);
+//
+// Levels above LOG_MAX_LEVEL are compiled out altogether, e.g. make CXXFLAGS+=-DLOG_MAX_LEVEL=1
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 4
+#endif
+
+#define LOG(message, level)                                             \
+    do {                                                                \
+        if((level) <= LOG_MAX_LEVEL && (level) <= LogLevel()) {         \
+            SimOutput(message, level);                                  \
+        }                                                               \
+    } while(0)
+
+// Highest level messages are built for: CLOUDSIM_LOG_LEVEL, or all of them if it is unset
+unsigned LogLevel();
+// For drivers that run the scheduler in process and know the level, e.g. against FakeSimulator
+void SetLogLevel(unsigned level);
+
+// Binary audit trail of the simulator upcalls, the cheap counterpart of the level 4 messages. Each
+// upcall becomes a fixed 16 byte record in a ring buffer that keeps the most recent AUDIT_CAPACITY
+// of them, written out oldest first at the end of the run. Off unless CLOUDSIM_AUDIT names the file
+// to write; then the cost per upcall is a store into the ring.
+//
+// File layout, little endian: "CSAUDIT1", a uint64_t record count, then the records.
+enum AuditEvent_t : uint32_t {
+    AUDIT_NEW_TASK,
+    AUDIT_TASK_COMPLETE,
+    AUDIT_MEMORY_WARNING,
+    AUDIT_MIGRATION_DONE,
+    AUDIT_SCHEDULER_CHECK,
+    AUDIT_SLA_WARNING,
+    AUDIT_STATE_CHANGE
+};
+
+struct AuditRecord_t {
+    Time_t time;
+    AuditEvent_t event;
+    uint32_t id;                            // Task, machine or VM id, as fits the event; 0 for checks
+};
+
+namespace AuditTrail {
+    extern bool enabled;
+
+    void Init();
+    void Append(AuditEvent_t event, Time_t time, uint32_t id);
+    void Write();
+}
+
+inline void Audit(AuditEvent_t event, Time_t time, uint32_t id) {
+    if(AuditTrail::enabled) {
+        AuditTrail::Append(event, time, id);
+    }
+}
+
+#endif /* Log_hpp */
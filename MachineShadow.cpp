@@ -0,0 +1,207 @@
+//
+//  MachineShadow.cpp
+//  CloudSim
+//
+
+#include "MachineShadow.hpp"
+
+#include <algorithm>
+
+#include "Interfaces.h"
+#include "Log.hpp"
+
+// S-state draw relative to S0, taken from the reference machine in the project description
+// (120, 100, 100, 80, 40, 10, 0 W). Used until a state has been measured.
+static const double reference_s_state_power[S_STATES] = { 1, 100.0 / 120, 100.0 / 120, 80.0 / 120, 40.0 / 120, 10.0 / 120, 0 };
+
+// The C-state an S-state puts idle cores in
+static CPUState_t CoreState(MachineState_t s) {
+    if(s == S0 || s == S0i1) {
+        return C1;
+    }
+    return s == S1 ? C2 : C4;
+}
+
+// Copy a spec table into its flattened slot, padding short tables with their last entry
+static void CopyTable(vector<unsigned> & table, const vector<unsigned> & source, unsigned entries) {
+    for(unsigned i = 0; i < entries; i++) {
+        table.push_back(source.empty() ? 0 : source[min<size_t>(i, source.size() - 1)]);
+    }
+}
+
+void MachineShadow::Init() {
+    unsigned total = Machine_GetTotal();
+    cpu.reserve(total);
+    gpus.reserve(total);
+    num_cpus.reserve(total);
+    memory_size.reserve(total);
+    mips.reserve(total * P_STATES);
+    p_state_power.reserve(total * P_STATES);
+    c_state_power.reserve(total * C_STATES);
+    machine_class.reserve(total);
+
+    vector<MachineId_t> representatives;
+    for(MachineId_t machine_id = 0; machine_id < total; machine_id++) {
+        MachineInfo_t info = Machine_GetInfo(machine_id);
+        cpu.push_back(info.cpu);
+        gpus.push_back(info.gpus);
+        num_cpus.push_back(info.num_cpus);
+        memory_size.push_back(info.memory_size);
+        CopyTable(mips, info.performance, P_STATES);
+        CopyTable(p_state_power, info.p_states, P_STATES);
+        CopyTable(c_state_power, info.c_states, C_STATES);
+
+        memory_used.push_back(info.memory_used);
+        active_tasks.push_back(info.active_tasks);
+        active_vms.push_back(info.active_vms);
+        s_state.push_back(info.s_state);
+        p_state.push_back(info.p_state);
+        changing.push_back(false);
+        incoming.push_back(0);
+        reserved.push_back(0);
+        headroom.push_back(0);
+        memory_blocked.push_back(false);
+        last_energy.push_back(info.energy_consumed);
+        quiet.push_back(true);
+
+        // Find the class of machines with the same specs, or start a new one
+        auto same_specs = [&](MachineId_t other) {
+            return cpu[other] == info.cpu && gpus[other] == info.gpus && num_cpus[other] == info.num_cpus
+                && memory_size[other] == info.memory_size
+                && equal(mips.begin() + other * P_STATES, mips.begin() + (other + 1) * P_STATES, mips.end() - P_STATES)
+                && equal(p_state_power.begin() + other * P_STATES, p_state_power.begin() + (other + 1) * P_STATES, p_state_power.end() - P_STATES)
+                && equal(c_state_power.begin() + other * C_STATES, c_state_power.begin() + (other + 1) * C_STATES, c_state_power.end() - C_STATES);
+        };
+        unsigned class_id = 0;
+        while(class_id < representatives.size() && !same_specs(representatives[class_id])) {
+            class_id++;
+        }
+        machine_class.push_back(class_id);
+        if(class_id == representatives.size()) {
+            representatives.push_back(machine_id);
+            CopyTable(s_state_power, info.s_states, S_STATES);
+            s_state_known.insert(s_state_known.end(), S_STATES, !info.s_states.empty());
+        }
+    }
+}
+
+void MachineShadow::Refresh(MachineId_t machine_id) {
+    MachineInfo_t info = Machine_GetInfo(machine_id);
+    memory_used[machine_id] = info.memory_used + reserved[machine_id];
+    active_tasks[machine_id] = info.active_tasks;
+    active_vms[machine_id] = info.active_vms;
+    s_state[machine_id] = info.s_state;
+    p_state[machine_id] = info.p_state;
+    changing[machine_id] = false;
+    quiet[machine_id] = false;
+}
+
+void MachineShadow::Sample(Time_t now) {
+    Time_t elapsed = now - last_sample;
+    last_sample = now;
+    for(MachineId_t machine_id = 0; machine_id < Total(); machine_id++) {
+        // Only a machine sitting idle in a state whose draw is still a guess can teach anything, so
+        // only those are read. Skipping a machine drops its baseline.
+        unsigned class_id = machine_class[machine_id];
+        MachineState_t s = s_state[machine_id];
+        if(changing[machine_id] || active_tasks[machine_id] != 0 || s_state_known[class_id * S_STATES + s]) {
+            quiet[machine_id] = false;
+            continue;
+        }
+        uint64_t energy = Machine_GetEnergy(machine_id);
+        if(quiet[machine_id] && elapsed > 0) {
+            // Energy is in watt-microseconds, so this is the draw in watts
+            double power = double(energy - last_energy[machine_id]) / elapsed;
+            double core_power = double(num_cpus[machine_id]) * IdleCorePower(machine_id, CoreState(s));
+            Learn(class_id, s, unsigned(max(0.0, power - core_power) + 0.5));
+        }
+        last_energy[machine_id] = energy;
+        quiet[machine_id] = true;
+    }
+}
+
+void MachineShadow::Learn(unsigned class_id, MachineState_t s, unsigned power) {
+    unsigned * table = &s_state_power[class_id * S_STATES];
+    char * known = &s_state_known[class_id * S_STATES];
+    table[s] = power;
+    known[s] = true;
+    power_revision++;
+    LOG("MachineShadow::Learn(): Machine class " + to_string(class_id) + " draws " + to_string(power) + " W in S-state " + to_string(s), 3);
+    if(s != S0) {
+        return;
+    }
+    // Scale the states not measured yet from the new S0 figure
+    for(unsigned state = 1; state < S_STATES; state++) {
+        if(!known[state]) {
+            table[state] = unsigned(power * reference_s_state_power[state] + 0.5);
+        }
+    }
+}
+
+void MachineShadow::BeginStateChange(MachineId_t machine_id, MachineState_t state) {
+    changing[machine_id] = true;
+    quiet[machine_id] = false;
+    if(state != S0) {
+        s_state[machine_id] = state;
+    }
+}
+
+unsigned MachineShadow::IdlePower(MachineId_t machine_id, MachineState_t s) const {
+    return StatePower(machine_id, s) + num_cpus[machine_id] * IdleCorePower(machine_id, CoreState(s));
+}
+
+double MachineShadow::PeakMIPS(MachineId_t machine_id) const {
+    return double(MIPS(machine_id, p_state[machine_id])) * num_cpus[machine_id];
+}
+
+double MachineShadow::AvailableMIPS(MachineId_t machine_id) const {
+    // Cores end up shared evenly among the tasks on a machine, counting the new one, and everything
+    // runs at half speed once memory is overcommitted. A task that would get more than a core still
+    // only runs on one, but the excess keeps the ordering spread over the least loaded machines.
+    double core_mips = MIPS(machine_id, p_state[machine_id]);
+    double share = double(num_cpus[machine_id]) / (active_tasks[machine_id] + 1);
+    return core_mips * share * (FreeMemory(machine_id) < 0 ? 0.5 : 1.0);
+}
+
+void MachineShadow::AttachVM(MachineId_t machine_id, unsigned memory, unsigned tasks) {
+    memory_used[machine_id] += memory;
+    active_tasks[machine_id] += tasks;
+    active_vms[machine_id]++;
+    quiet[machine_id] = false;
+}
+
+void MachineShadow::DetachVM(MachineId_t machine_id, unsigned memory, unsigned tasks) {
+    memory_used[machine_id] -= memory;
+    active_tasks[machine_id] -= tasks;
+    active_vms[machine_id]--;
+    quiet[machine_id] = false;
+}
+
+void MachineShadow::AddTask(MachineId_t machine_id, unsigned memory) {
+    memory_used[machine_id] += memory;
+    active_tasks[machine_id]++;
+    quiet[machine_id] = false;
+}
+
+void MachineShadow::RemoveTask(MachineId_t machine_id, unsigned memory) {
+    memory_used[machine_id] -= memory;
+    active_tasks[machine_id]--;
+    quiet[machine_id] = false;
+}
+
+void MachineShadow::Reserve(MachineId_t machine_id, unsigned memory) {
+    memory_used[machine_id] += memory;
+    reserved[machine_id] += memory;
+    incoming[machine_id]++;
+}
+
+void MachineShadow::Release(MachineId_t machine_id, unsigned memory) {
+    memory_used[machine_id] -= memory;
+    reserved[machine_id] -= memory;
+    incoming[machine_id]--;
+}
+
+void MachineShadow::RefreshMemory(MachineId_t machine_id) {
+    memory_used[machine_id] = Machine_GetInfo(machine_id).memory_used + reserved[machine_id];
+    quiet[machine_id] = false;
+}
@@ -0,0 +1,115 @@
+//
+//  MachineShadow.hpp
+//  CloudSim
+//
+
+#ifndef MachineShadow_hpp
+#define MachineShadow_hpp
+
+#include <vector>
+
+#include "SimTypes.h"
+
+// Scheduler-side copy of the machine state the policies look at, stored as one array per field.
+//
+// Machine_GetInfo() returns MachineInfo_t by value, and with it four freshly allocated vectors
+// (performance, c_states, p_states, s_states). The static specs never change, so they are captured
+// once in Init(). The dynamic fields are kept current from the scheduler's own actions and events.
+// Refresh() re-reads them from the simulator; it is only needed where the simulator changes a
+// machine on its own, like completing a state change. Reading the shadow never allocates.
+//
+// The simulator leaves s_states empty, so the S-state power figures are learned instead: every check,
+// Sample() reads the energy counters of the idle machines sitting in a state not measured yet, and
+// one that sat there with nothing changing for a whole period gives that state's draw for its whole
+// machine class. Busy machines and machines in known states are not read at all.
+// States not seen yet are estimated from the class's S0 figure.
+class MachineShadow {
+public:
+    void Init();
+    void Refresh(MachineId_t machine_id);
+    void Sample(Time_t now);
+    unsigned Total() const                                          { return unsigned(cpu.size()); }
+
+    // Static specs
+    CPUType_t CPU(MachineId_t machine_id) const                     { return cpu[machine_id]; }
+    bool HasGPU(MachineId_t machine_id) const                       { return gpus[machine_id]; }
+    unsigned NumCPUs(MachineId_t machine_id) const                  { return num_cpus[machine_id]; }
+    unsigned MemorySize(MachineId_t machine_id) const               { return memory_size[machine_id]; }
+    unsigned MIPS(MachineId_t machine_id, CPUPerformance_t p) const { return mips[machine_id * P_STATES + p]; }
+    unsigned CorePower(MachineId_t machine_id, CPUPerformance_t p) const { return p_state_power[machine_id * P_STATES + p]; }
+    unsigned IdleCorePower(MachineId_t machine_id, CPUState_t c) const   { return c_state_power[machine_id * C_STATES + c]; }
+    unsigned StatePower(MachineId_t machine_id, MachineState_t s) const  { return s_state_power[machine_class[machine_id] * S_STATES + s]; }
+    // Whole machine draw in state s with no task running: the S-state figure plus every core in the
+    // C-state that S-state puts it in
+    unsigned IdlePower(MachineId_t machine_id, MachineState_t s) const;
+    // Bumped whenever a learned figure changes the S-state power tables
+    unsigned PowerRevision() const                                  { return power_revision; }
+
+    // Dynamic state
+    unsigned MemoryUsed(MachineId_t machine_id) const               { return memory_used[machine_id]; }
+    unsigned ActiveTasks(MachineId_t machine_id) const              { return active_tasks[machine_id]; }
+    unsigned ActiveVMs(MachineId_t machine_id) const                { return active_vms[machine_id]; }
+    MachineState_t State(MachineId_t machine_id) const              { return s_state[machine_id]; }
+    CPUPerformance_t PState(MachineId_t machine_id) const           { return p_state[machine_id]; }
+    bool IsReady(MachineId_t machine_id) const                      { return s_state[machine_id] == S0; }
+    bool IsChanging(MachineId_t machine_id) const                   { return changing[machine_id]; }
+    unsigned Incoming(MachineId_t machine_id) const                 { return incoming[machine_id]; }
+    long long FreeMemory(MachineId_t machine_id) const              { return (long long) memory_size[machine_id] - memory_used[machine_id]; }
+    // Memory new work may take: what is free less the headroom kept on the machine
+    long long PlaceableMemory(MachineId_t machine_id) const         { return FreeMemory(machine_id) - headroom[machine_id]; }
+    unsigned Headroom(MachineId_t machine_id) const                 { return headroom[machine_id]; }
+    // Placement holds off a machine the simulator found overcommitted until its memory drops
+    bool IsMemoryBlocked(MachineId_t machine_id) const              { return memory_blocked[machine_id]; }
+    double PeakMIPS(MachineId_t machine_id) const;
+    // MIPS the next task placed on the machine would run at
+    double AvailableMIPS(MachineId_t machine_id) const;
+
+    // Bookkeeping for the scheduler's own actions
+    void AttachVM(MachineId_t machine_id, unsigned memory, unsigned tasks);
+    void DetachVM(MachineId_t machine_id, unsigned memory, unsigned tasks);
+    void AddTask(MachineId_t machine_id, unsigned memory);
+    void RemoveTask(MachineId_t machine_id, unsigned memory);
+    // Hold memory on the destination of a migration until the VM lands
+    void Reserve(MachineId_t machine_id, unsigned memory);
+    void Release(MachineId_t machine_id, unsigned memory);
+    // Re-read only the memory in use. A migration leaves the VM's task memory charged to its old
+    // host, and the simulator is the one that decides when memory is overcommitted.
+    void RefreshMemory(MachineId_t machine_id);
+    // A machine going down stops being ready right away; one coming up only once Refresh() sees it in S0
+    void BeginStateChange(MachineId_t machine_id, MachineState_t state);
+    void SetHeadroom(MachineId_t machine_id, unsigned memory)       { headroom[machine_id] = memory; }
+    void SetMemoryBlocked(MachineId_t machine_id, bool blocked)     { memory_blocked[machine_id] = blocked; }
+    void SetPState(MachineId_t machine_id, CPUPerformance_t state)  { p_state[machine_id] = state; quiet[machine_id] = false; }
+private:
+    void Learn(unsigned machine_class, MachineState_t s, unsigned power);
+
+    vector<CPUType_t> cpu;
+    vector<char> gpus;
+    vector<unsigned> num_cpus;
+    vector<unsigned> memory_size;
+    vector<unsigned> mips;                  // P_STATES entries per machine
+    vector<unsigned> p_state_power;         // P_STATES entries per machine
+    vector<unsigned> c_state_power;         // C_STATES entries per machine
+    vector<unsigned> machine_class;         // Machines with identical specs share a class
+    vector<unsigned> s_state_power;         // S_STATES entries per class
+    vector<char> s_state_known;             // S_STATES entries per class, false while estimated
+    unsigned power_revision = 0;
+
+    vector<unsigned> memory_used;
+    vector<unsigned> active_tasks;
+    vector<unsigned> active_vms;
+    vector<MachineState_t> s_state;
+    vector<CPUPerformance_t> p_state;
+    vector<char> changing;
+    vector<unsigned> incoming;              // Migrations on their way in
+    vector<unsigned> reserved;              // Memory they hold, included in memory_used
+    vector<unsigned> headroom;
+    vector<char> memory_blocked;
+
+    // Energy sampling
+    vector<uint64_t> last_energy;
+    vector<char> quiet;                     // Nothing changed since the last sample
+    Time_t last_sample = 0;
+};
+
+#endif /* MachineShadow_hpp */
@@ -0,0 +1,111 @@
+//
+//  MemoryGuard.cpp
+//  CloudSim
+//
+
+#include "MemoryGuard.hpp"
+
+#include <cstdlib>
+
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Scheduler.hpp"
+
+// Environment variable with the share of each machine's memory kept free, in percent
+#define HEADROOM_VARIABLE   "CLOUDSIM_MEMORY_HEADROOM"
+#define DEFAULT_HEADROOM    0
+
+void MemoryGuard::Init() {
+    const char * value = getenv(HEADROOM_VARIABLE);
+    double percent = value != nullptr && *value != '\0' ? atof(value) : DEFAULT_HEADROOM;
+    if(percent < 0 || percent >= 100) {
+        ThrowException("MemoryGuard::Init(): " HEADROOM_VARIABLE " has to be a percentage below 100, not ", value);
+    }
+    for(MachineId_t machine_id = 0; machine_id < machines.Total(); machine_id++) {
+        machines.SetHeadroom(machine_id, unsigned(machines.MemorySize(machine_id) * percent / 100));
+    }
+    blocked_since.assign(machines.Total(), 0);
+}
+
+void MemoryGuard::MemoryWarning(Scheduler & scheduler, Time_t now, MachineId_t machine_id) {
+    warnings++;
+    machines.RefreshMemory(machine_id);
+    if(!machines.IsMemoryBlocked(machine_id)) {
+        LOG("MemoryGuard::MemoryWarning(): Machine " + to_string(machine_id) + " is overcommitted, no more placements there", 2);
+        machines.SetMemoryBlocked(machine_id, true);
+        blocked_since[machine_id] = now;
+        placement.Update(machine_id);
+    }
+
+    // One evacuation at a time: whatever is already leaving may be enough
+    for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+        if(scheduler.IsMigrating(vm_id)) {
+            return;
+        }
+    }
+    bool gpu = false;
+    VMId_t vm_id = Evacuee(machine_id, gpu);
+    if(vm_id == NO_VM) {
+        return;
+    }
+    // The blocked machine is out of the buckets, so it cannot come back as the target
+    MachineId_t target = placement.FindMachine(machines.CPU(machine_id), gpu, placement.MemoryOf(vm_id));
+    if(target == NO_MACHINE) {
+        LOG("MemoryGuard::MemoryWarning(): No room anywhere for VM " + to_string(vm_id) + " of machine " + to_string(machine_id), 2);
+        return;
+    }
+    evacuations++;
+    scheduler.MigrateVM(vm_id, target);
+}
+
+void MemoryGuard::LoadDropped(Time_t now, MachineId_t machine_id) {
+    if(!machines.IsMemoryBlocked(machine_id) || machines.PlaceableMemory(machine_id) < 0) {
+        return;
+    }
+    LOG("MemoryGuard::LoadDropped(): Machine " + to_string(machine_id) + " is back under its headroom", 2);
+    machines.SetMemoryBlocked(machine_id, false);
+    overcommitted_time += now - blocked_since[machine_id];
+    placement.Update(machine_id);
+}
+
+void MemoryGuard::Report(Time_t now) const {
+    Time_t total = overcommitted_time;
+    for(MachineId_t machine_id = 0; machine_id < machines.Total(); machine_id++) {
+        if(machines.IsMemoryBlocked(machine_id)) {
+            total += now - blocked_since[machine_id];
+        }
+    }
+    if(warnings == 0) {
+        return;
+    }
+    LOG("MemoryGuard::Report(): " + to_string(warnings) + " memory warnings, " + to_string(evacuations) + " VMs evacuated, machines overcommitted for "
+        + to_string(double(total) / 1000000) + " s in total", 1);
+}
+
+// The VM on the machine whose most important task matters least, the larger of two such, or NO_VM
+// if nothing on the machine can move. Sets gpu if one of its tasks needs a GPU host.
+VMId_t MemoryGuard::Evacuee(MachineId_t machine_id, bool & gpu) const {
+    VMId_t best = NO_VM;
+    Priority_t best_priority = HIGH_PRIORITY;
+    for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+        if(residency.TaskCount(vm_id) == 0) {
+            continue;
+        }
+        // Priorities count down from HIGH_PRIORITY, so the most important task has the lowest value
+        Priority_t priority = LOW_PRIORITY;
+        for(TaskId_t task_id = residency.FirstTask(vm_id); task_id != NO_TASK; task_id = residency.NextTask(task_id)) {
+            priority = min(priority, SLAPriority(RequiredSLA(task_id)));
+        }
+        if(best == NO_VM || priority > best_priority || (priority == best_priority && placement.MemoryOf(vm_id) > placement.MemoryOf(best))) {
+            best = vm_id;
+            best_priority = priority;
+        }
+    }
+    gpu = false;
+    if(best != NO_VM && machines.HasGPU(machine_id)) {
+        for(TaskId_t task_id = residency.FirstTask(best); task_id != NO_TASK && !gpu; task_id = residency.NextTask(task_id)) {
+            gpu = IsTaskGPUCapable(task_id);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,50 @@
+//
+//  MemoryGuard.hpp
+//  CloudSim
+//
+
+#ifndef MemoryGuard_hpp
+#define MemoryGuard_hpp
+
+#include <vector>
+
+#include "MachineShadow.hpp"
+#include "PlacementIndex.hpp"
+#include "ReverseIndex.hpp"
+#include "SimTypes.h"
+
+class Scheduler;
+
+// Keeps machines out of memory overcommitment, which slows every core on the machine down.
+//
+// Placement already counts every task's memory and the VM_MEMORY_OVERHEAD of every VM, and leaves a
+// headroom of CLOUDSIM_MEMORY_HEADROOM percent of each machine's memory alone (none by default).
+// The guard handles what gets past that: when the simulator reports a machine overcommitted, the
+// machine is blocked for placement until its memory drops back under the headroom, and its lowest
+// priority VM is migrated to a compatible machine with room for it, if there is one. Time spent
+// overcommitted is reported at -v 1.
+class MemoryGuard {
+public:
+    MemoryGuard(MachineShadow & machines, PlacementIndex & placement, const ReverseIndex & residency)
+        : machines(machines), placement(placement), residency(residency) {}
+
+    void Init();
+    // Starts the evacuation through Scheduler::MigrateVM
+    void MemoryWarning(Scheduler & scheduler, Time_t now, MachineId_t machine_id);
+    // A task finished or a VM left; unblocks the machine once its memory is back under the headroom
+    void LoadDropped(Time_t now, MachineId_t machine_id);
+    void Report(Time_t now) const;
+private:
+    VMId_t Evacuee(MachineId_t machine_id, bool & gpu) const;
+
+    MachineShadow & machines;
+    PlacementIndex & placement;
+    const ReverseIndex & residency;
+
+    vector<Time_t> blocked_since;               // Per machine, while blocked
+    Time_t overcommitted_time = 0;              // Summed over machines
+    unsigned warnings = 0;
+    unsigned evacuations = 0;
+};
+
+#endif /* MemoryGuard_hpp */
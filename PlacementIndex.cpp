@@ -0,0 +1,280 @@
+//
+//  PlacementIndex.cpp
+//  CloudSim
+//
+
+#include "PlacementIndex.hpp"
+
+#include <algorithm>
+
+void PlacementIndex::AddMachine(MachineId_t machine_id) {
+    if(machine_id >= machine_entries.size()) {
+        machine_entries.resize(machine_id + 1);
+    }
+    machine_entries[machine_id].linked = false;
+    Update(machine_id);
+}
+
+void PlacementIndex::AddVM(VMId_t vm_id, VMType_t vm_type, MachineId_t machine_id) {
+    if(vm_id >= vm_entries.size()) {
+        vm_entries.resize(vm_id + 1);
+    }
+    VMEntry & vm = vm_entries[vm_id];
+    vm.vm_type = vm_type;
+    vm.memory_used = VM_MEMORY_OVERHEAD;
+    vm.valid = true;
+    vm.migrating = false;
+    vm.reserved = 0;
+    residency.AddVM(vm_id, machine_id);
+    Attach(vm_id);
+}
+
+void PlacementIndex::RemoveVM(VMId_t vm_id) {
+    if(vm_id >= vm_entries.size() || !vm_entries[vm_id].valid) {
+        return;
+    }
+    MachineId_t machine_id = residency.MachineOf(vm_id);
+    Detach(vm_id);
+    residency.RemoveVM(vm_id);
+    vm_entries[vm_id].valid = false;
+    Update(machine_id);
+}
+
+void PlacementIndex::BeginMigration(VMId_t vm_id, MachineId_t machine_id) {
+    VMEntry & vm = vm_entries[vm_id];
+    MachineEntry & entry = machine_entries[residency.MachineOf(vm_id)];
+    if(entry.linked) {
+        Unlink(vm_id, entry.vm_key);
+    }
+    vm.migrating = true;
+    // Tasks may finish while it is on its way, so remember what was held to give back exactly that
+    vm.reserved = vm.memory_used;
+    machines.Reserve(machine_id, vm.reserved);
+    Update(machine_id);
+}
+
+void PlacementIndex::MoveVM(VMId_t vm_id, MachineId_t machine_id) {
+    // The VM takes its memory and tasks along to the new host
+    MachineId_t old_machine = residency.MachineOf(vm_id);
+    if(!vm_entries[vm_id].valid || old_machine == machine_id) {
+        return;
+    }
+    if(vm_entries[vm_id].migrating) {
+        // The reservation turns into the VM itself
+        machines.Release(machine_id, vm_entries[vm_id].reserved);
+        vm_entries[vm_id].migrating = false;
+    }
+    Detach(vm_id);
+    residency.MoveVM(vm_id, machine_id);
+    Update(old_machine);
+    Attach(vm_id);
+}
+
+void PlacementIndex::AddTask(TaskId_t task_id, VMId_t vm_id, unsigned memory) {
+    MachineId_t machine_id = residency.MachineOf(vm_id);
+    residency.AddTask(task_id, vm_id);
+    vm_entries[vm_id].memory_used += memory;
+    machines.AddTask(machine_id, memory);
+    Update(machine_id);
+}
+
+void PlacementIndex::RemoveTask(TaskId_t task_id, unsigned memory) {
+    VMId_t vm_id = residency.VMOf(task_id);
+    if(vm_id == NO_VM) {
+        return;
+    }
+    MachineId_t machine_id = residency.MachineOf(vm_id);
+    residency.RemoveTask(task_id);
+    vm_entries[vm_id].memory_used -= memory;
+    machines.RemoveTask(machine_id, memory);
+    Update(machine_id);
+}
+
+void PlacementIndex::Update(MachineId_t machine_id) {
+    MachineEntry & entry = machine_entries[machine_id];
+    unsigned machine_bucket_id = MachineBucketOf(machines.CPU(machine_id), machines.HasGPU(machine_id));
+    MachineBucket & machine_bucket = machine_buckets[machine_bucket_id];
+
+    if(!machines.IsReady(machine_id) || machines.IsMemoryBlocked(machine_id)) {
+        if(entry.linked) {
+            machine_bucket.erase({entry.machine_key, machine_id});
+            machine_ids[machine_bucket_id].erase(machine_id);
+            for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+                Unlink(vm_id, entry.vm_key);
+            }
+            entry.linked = false;
+        }
+        return;
+    }
+
+    long long machine_key = -machines.PlaceableMemory(machine_id);
+    double vm_key = -machines.AvailableMIPS(machine_id);
+    if(!entry.linked) {
+        machine_bucket.insert({machine_key, machine_id});
+        machine_ids[machine_bucket_id].insert(machine_id);
+        for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+            if(!vm_entries[vm_id].migrating) {
+                Link(vm_id, vm_key);
+            }
+        }
+    }
+    else {
+        // Re-key the existing nodes in place instead of erasing and allocating new ones
+        if(machine_key != entry.machine_key) {
+            auto node = machine_bucket.extract({entry.machine_key, machine_id});
+            node.value().first = machine_key;
+            machine_bucket.insert(move(node));
+        }
+        if(vm_key != entry.vm_key) {
+            for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+                if(vm_entries[vm_id].migrating) {
+                    continue;
+                }
+                VMBucket & bucket = BucketOf(vm_id);
+                auto node = bucket.extract({entry.vm_key, vm_id});
+                if(node.empty()) {
+                    // A VM that just arrived on this machine has no node yet
+                    Link(vm_id, vm_key);
+                    continue;
+                }
+                node.value().first = vm_key;
+                bucket.insert(move(node));
+            }
+        }
+    }
+    entry.linked = true;
+    entry.machine_key = machine_key;
+    entry.vm_key = vm_key;
+}
+
+VMId_t PlacementIndex::FindVM(CPUType_t cpu, VMType_t vm_type, bool gpu, unsigned memory) const {
+    // A non-GPU task can go to either bucket, so find the first fit in each and take the better one
+    const VMBucket & gpu_bucket = vm_buckets[VMBucketOf(cpu, vm_type, true)];
+    const VMBucket & plain_bucket = vm_buckets[VMBucketOf(cpu, vm_type, false)];
+
+    auto first_fit = [&](const VMBucket & bucket) {
+        for(auto it = bucket.begin(); it != bucket.end(); it++) {
+            if(machines.PlaceableMemory(residency.MachineOf(it->second)) >= memory) {
+                return it;
+            }
+        }
+        return bucket.end();
+    };
+
+    auto best_gpu = first_fit(gpu_bucket);
+    if(gpu) {
+        return best_gpu == gpu_bucket.end() ? NO_VM : best_gpu->second;
+    }
+    auto best_plain = first_fit(plain_bucket);
+    if(best_gpu == gpu_bucket.end()) {
+        return best_plain == plain_bucket.end() ? NO_VM : best_plain->second;
+    }
+    if(best_plain == plain_bucket.end()) {
+        return best_gpu->second;
+    }
+    return *best_plain < *best_gpu ? best_plain->second : best_gpu->second;
+}
+
+MachineId_t PlacementIndex::FindMachine(CPUType_t cpu, bool gpu, unsigned memory) const {
+    // Buckets are ordered by placeable memory, so only the front of each needs checking
+    MachineId_t best = NO_MACHINE;
+    pair<long long, MachineId_t> best_key;
+    for(bool with_gpu : {false, true}) {
+        if(gpu && !with_gpu) {
+            continue;
+        }
+        const MachineBucket & bucket = machine_buckets[MachineBucketOf(cpu, with_gpu)];
+        if(bucket.empty() || -bucket.begin()->first < (long long) memory) {
+            continue;
+        }
+        if(best == NO_MACHINE || *bucket.begin() < best_key) {
+            best_key = *bucket.begin();
+            best = best_key.second;
+        }
+    }
+    return best;
+}
+
+VMId_t PlacementIndex::FirstFitVM(CPUType_t cpu, VMType_t vm_type, bool gpu, unsigned memory) const {
+    auto first_fit = [&](const set<VMId_t> & ids) {
+        for(VMId_t vm_id : ids) {
+            if(machines.PlaceableMemory(residency.MachineOf(vm_id)) >= memory) {
+                return vm_id;
+            }
+        }
+        return NO_VM;
+    };
+
+    // A non-GPU task can go to either bucket; NO_VM is the largest id, so min() takes the real fit
+    VMId_t best = first_fit(vm_ids[VMBucketOf(cpu, vm_type, true)]);
+    if(!gpu) {
+        best = min(best, first_fit(vm_ids[VMBucketOf(cpu, vm_type, false)]));
+    }
+    return best;
+}
+
+MachineId_t PlacementIndex::FirstFitMachine(CPUType_t cpu, bool gpu, unsigned memory) const {
+    auto first_fit = [&](const set<MachineId_t> & ids) {
+        for(MachineId_t machine_id : ids) {
+            if(machines.PlaceableMemory(machine_id) >= memory) {
+                return machine_id;
+            }
+        }
+        return NO_MACHINE;
+    };
+
+    MachineId_t best = first_fit(machine_ids[MachineBucketOf(cpu, true)]);
+    if(!gpu) {
+        best = min(best, first_fit(machine_ids[MachineBucketOf(cpu, false)]));
+    }
+    return best;
+}
+
+const PlacementIndex::VMBucket & PlacementIndex::VMs(CPUType_t cpu, VMType_t vm_type, bool gpu) const {
+    return vm_buckets[VMBucketOf(cpu, vm_type, gpu)];
+}
+
+const PlacementIndex::MachineBucket & PlacementIndex::Machines(CPUType_t cpu, bool gpu) const {
+    return machine_buckets[MachineBucketOf(cpu, gpu)];
+}
+
+PlacementIndex::VMBucket & PlacementIndex::BucketOf(VMId_t vm_id) {
+    MachineId_t machine_id = residency.MachineOf(vm_id);
+    return vm_buckets[VMBucketOf(machines.CPU(machine_id), vm_entries[vm_id].vm_type, machines.HasGPU(machine_id))];
+}
+
+void PlacementIndex::Link(VMId_t vm_id, double vm_key) {
+    VMBucket & bucket = BucketOf(vm_id);
+    bucket.insert({vm_key, vm_id});
+    vm_ids[&bucket - vm_buckets].insert(vm_id);
+}
+
+void PlacementIndex::Unlink(VMId_t vm_id, double vm_key) {
+    VMBucket & bucket = BucketOf(vm_id);
+    bucket.erase({vm_key, vm_id});
+    vm_ids[&bucket - vm_buckets].erase(vm_id);
+}
+
+// Account for a VM the reverse index has just placed on its (new) host
+void PlacementIndex::Attach(VMId_t vm_id) {
+    MachineId_t machine_id = residency.MachineOf(vm_id);
+    machines.AttachVM(machine_id, vm_entries[vm_id].memory_used, residency.TaskCount(vm_id));
+    Update(machine_id);
+
+    // Update() only re-keys when the host's key changed, so make sure the VM itself is bucketed
+    MachineEntry & entry = machine_entries[machine_id];
+    if(entry.linked) {
+        Link(vm_id, entry.vm_key);
+    }
+}
+
+// Take a VM off the books of its current host, before the reverse index moves or drops it.
+// The host is re-sorted by the caller once the VM is gone from its list.
+void PlacementIndex::Detach(VMId_t vm_id) {
+    MachineId_t machine_id = residency.MachineOf(vm_id);
+    MachineEntry & entry = machine_entries[machine_id];
+    if(entry.linked) {
+        Unlink(vm_id, entry.vm_key);
+    }
+    machines.DetachVM(machine_id, vm_entries[vm_id].memory_used, residency.TaskCount(vm_id));
+}
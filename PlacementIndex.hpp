@@ -0,0 +1,99 @@
+//
+//  PlacementIndex.hpp
+//  CloudSim
+//
+
+#ifndef PlacementIndex_hpp
+#define PlacementIndex_hpp
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "MachineShadow.hpp"
+#include "ReverseIndex.hpp"
+#include "SimTypes.h"
+
+// Buckets VMs by (CPU type, VM type, GPU) and machines by (CPU type, GPU) so that placing a task only
+// looks at compatible candidates. Each bucket is kept ordered with the best candidate first:
+// VMs by the available MIPS of their host, machines by placeable memory (free memory less the
+// headroom). Only machines in S0 that are not blocked for memory are bucketed, so everything
+// returned can accept work right away. Each bucket's members are also kept ordered by id, for
+// policies that place first-fit.
+//
+// The index does not poll the simulator. The scheduler feeds it every event that changes load or
+// placement (VM attached, task added/completed, migration done, state change); the index records
+// the move in the reverse index, updates the machine shadow and repositions the affected entries
+// in O(log n). Entries are moved by re-keying their set nodes, so steady-state updates do not allocate.
+class PlacementIndex {
+public:
+    typedef set<pair<double, VMId_t>> VMBucket;             // (-available MIPS of host, vm)
+    typedef set<pair<long long, MachineId_t>> MachineBucket; // (-placeable memory, machine)
+
+    PlacementIndex(MachineShadow & machines, ReverseIndex & residency) : machines(machines), residency(residency) {}
+
+    void AddMachine(MachineId_t machine_id);
+    void AddVM(VMId_t vm_id, VMType_t vm_type, MachineId_t machine_id);
+    void RemoveVM(VMId_t vm_id);
+    // A migrating VM leaves the buckets and holds its memory on the destination until MoveVM() lands it
+    void BeginMigration(VMId_t vm_id, MachineId_t machine_id);
+    void MoveVM(VMId_t vm_id, MachineId_t machine_id);
+    void AddTask(TaskId_t task_id, VMId_t vm_id, unsigned memory);
+    void RemoveTask(TaskId_t task_id, unsigned memory);
+    // Re-sort a machine after its shadow state changed outside the calls above (e.g. a state change)
+    void Update(MachineId_t machine_id);
+
+    // Ready VM with the most available MIPS whose host can still fit memory, or NO_VM.
+    // A GPU task only matches GPU hosts; other tasks match either.
+    VMId_t FindVM(CPUType_t cpu, VMType_t vm_type, bool gpu, unsigned memory) const;
+    // Ready machine with the most placeable memory that can fit memory, or NO_MACHINE. A task that
+    // needs a new VM needs room for VM_MEMORY_OVERHEAD as well.
+    MachineId_t FindMachine(CPUType_t cpu, bool gpu, unsigned memory) const;
+    // First fit: the ready VM, or machine, with the lowest id whose host can fit memory. These walk
+    // the candidates in id order and stop at the first that fits.
+    VMId_t FirstFitVM(CPUType_t cpu, VMType_t vm_type, bool gpu, unsigned memory) const;
+    MachineId_t FirstFitMachine(CPUType_t cpu, bool gpu, unsigned memory) const;
+
+    // Raw buckets for policies that want to score every compatible candidate themselves
+    const VMBucket & VMs(CPUType_t cpu, VMType_t vm_type, bool gpu) const;
+    const MachineBucket & Machines(CPUType_t cpu, bool gpu) const;
+
+    MachineId_t HostOf(VMId_t vm_id) const              { return residency.MachineOf(vm_id); }
+    unsigned MemoryOf(VMId_t vm_id) const               { return vm_entries[vm_id].memory_used; }
+    VMType_t TypeOf(VMId_t vm_id) const                 { return vm_entries[vm_id].vm_type; }
+    bool IsMigrating(VMId_t vm_id) const                { return vm_entries[vm_id].migrating; }
+private:
+    struct MachineEntry {
+        bool linked;                            // Currently present in the buckets
+        long long machine_key;                  // Keys it was inserted with
+        double vm_key;
+    };
+    struct VMEntry {
+        VMType_t vm_type;
+        unsigned memory_used;                   // Overhead plus memory of the tasks it hosts
+        bool valid;
+        bool migrating;                         // Out of the buckets until the migration completes
+        unsigned reserved;                      // Memory held on the destination while migrating
+    };
+
+    static unsigned VMBucketOf(CPUType_t cpu, VMType_t vm_type, bool gpu) { return (unsigned(cpu) * 4 + vm_type) * 2 + gpu; }
+    static unsigned MachineBucketOf(CPUType_t cpu, bool gpu)              { return unsigned(cpu) * 2 + gpu; }
+
+    VMBucket & BucketOf(VMId_t vm_id);
+    void Link(VMId_t vm_id, double vm_key);
+    void Unlink(VMId_t vm_id, double vm_key);
+    void Attach(VMId_t vm_id);
+    void Detach(VMId_t vm_id);
+
+    MachineShadow & machines;
+    ReverseIndex & residency;
+    vector<MachineEntry> machine_entries;
+    vector<VMEntry> vm_entries;
+    VMBucket vm_buckets[4 * 4 * 2];
+    MachineBucket machine_buckets[4 * 2];
+    // The same members by id
+    set<VMId_t> vm_ids[4 * 4 * 2];
+    set<MachineId_t> machine_ids[4 * 2];
+};
+
+#endif /* PlacementIndex_hpp */
@@ -0,0 +1,32 @@
+//
+//  Policy.cpp
+//  CloudSim
+//
+
+#include "Policy.hpp"
+
+static const struct {
+    const char * name;
+    Policy * (*create)();
+} policies[] = {
+    { "best",   NewBestPolicy },
+    { "brute",  NewBrutePolicy },
+    { "greedy", NewGreedyPolicy },
+};
+
+Policy * CreatePolicy(const string & name) {
+    for(auto & policy : policies) {
+        if(name == policy.name) {
+            return policy.create();
+        }
+    }
+    return nullptr;
+}
+
+string PolicyNames() {
+    string names;
+    for(auto & policy : policies) {
+        names += (names.empty() ? "" : ", ") + string(policy.name);
+    }
+    return names;
+}
@@ -0,0 +1,40 @@
+//
+//  Policy.hpp
+//  CloudSim
+//
+
+#ifndef Policy_hpp
+#define Policy_hpp
+
+#include <string>
+
+#include "SimTypes.h"
+
+class Scheduler;
+
+// A scheduling policy plugged into the shared scheduler core. The core keeps the books and calls the
+// policy at each decision point. Only PlaceTask is required; the other hooks default to doing nothing.
+class Policy {
+public:
+    virtual ~Policy() {}
+
+    // Put the task on a VM through Scheduler::AddTask, getting a VM with Scheduler::ProvideVM if
+    // needed. Returns false if the task could not be placed.
+    virtual bool PlaceTask(Scheduler & scheduler, Time_t now, TaskId_t task_id) = 0;
+
+    virtual void PeriodicCheck(Scheduler & scheduler, Time_t now) {}
+    virtual void SLAWarning(Scheduler & scheduler, Time_t now, TaskId_t task_id) {}
+    virtual void MemoryWarning(Scheduler & scheduler, Time_t now, MachineId_t machine_id) {}
+    virtual void StateChangeComplete(Scheduler & scheduler, Time_t now, MachineId_t machine_id) {}
+};
+
+// Policy implementations
+Policy * NewBestPolicy();
+Policy * NewBrutePolicy();
+Policy * NewGreedyPolicy();
+
+// Registry: look a policy up by name ("best", "brute", "greedy"). Returns nullptr for unknown names.
+Policy * CreatePolicy(const string & name);
+string PolicyNames();
+
+#endif /* Policy_hpp */
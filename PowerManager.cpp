@@ -0,0 +1,254 @@
+//
+//  PowerManager.cpp
+//  CloudSim
+//
+
+#include "PowerManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Trace.hpp"
+
+// How long the simulator takes to enter each S-state from S0 and to come back, in microseconds.
+// It does not report these, they were measured against it.
+static const Time_t enter_latency[S_STATES] = { 0, 60000, 60000, 600000, 1500000, 3000000, 15000000 };
+static const Time_t wake_latency[S_STATES]  = { 0, 60000, 300000, 3000000, 6000000, 12000000, 300000000 };
+
+// States idle machines are parked in, shallowest first
+static const MachineState_t park_states[] = { S0i1, S3, S5 };
+
+// How many tasks a machine that was idle is expected to absorb. The placement estimates run out of
+// MIPS at two tasks per core, so this matches an 8 core machine.
+#define TASKS_PER_MACHINE 16
+// Spare pool sizing: keep enough idle S0 machines to absorb the arrivals expected over this many seconds
+#define SPARE_HORIZON   6.0
+// Arrival rates are smoothed over roughly this many seconds
+#define RATE_WINDOW     10.0
+
+void PowerManager::Init() {
+    unsigned total = machines.Total();
+    idle_since.assign(total, 0);
+    park_due.assign(total, 0);
+    target_state.assign(total, S0);
+    in_transition.assign(total, false);
+    claimed.assign(total, 0);
+    for(MachineId_t machine_id = 0; machine_id < total; machine_id++) {
+        target_state[machine_id] = machines.State(machine_id);
+        bucket_machines[BucketOf(machines.CPU(machine_id), machines.HasGPU(machine_id))].push_back(machine_id);
+    }
+}
+
+void PowerManager::RecordArrival(CPUType_t cpu, bool gpu) {
+    // Tasks without a GPU need can also run on GPU machines, if those are all there is
+    unsigned bucket = BucketOf(cpu, gpu);
+    if(!gpu && bucket_machines[bucket].empty()) {
+        bucket = BucketOf(cpu, true);
+    }
+    arrivals[bucket]++;
+}
+
+void PowerManager::LoadDropped(Time_t now, MachineId_t machine_id) {
+    if(machines.ActiveTasks(machine_id) == 0) {
+        idle_since[machine_id] = now;
+        ScheduleParking(machine_id);
+    }
+}
+
+bool PowerManager::Wake(CPUType_t cpu, bool gpu, unsigned memory) {
+    // A machine that is already on its way up will do, as long as it has not been promised a full load
+    MachineId_t best = NO_MACHINE;
+    for(bool with_gpu : {false, true}) {
+        if(gpu && !with_gpu) {
+            continue;
+        }
+        for(MachineId_t machine_id : bucket_machines[BucketOf(cpu, with_gpu)]) {
+            if(IsWaking(machine_id) && claimed[machine_id] < TASKS_PER_MACHINE && machines.PlaceableMemory(machine_id) >= memory) {
+                claimed[machine_id]++;
+                return true;
+            }
+        }
+        MachineId_t machine_id = Sleeper(BucketOf(cpu, with_gpu), memory);
+        if(machine_id != NO_MACHINE && (best == NO_MACHINE || wake_latency[target_state[machine_id]] < wake_latency[target_state[best]])) {
+            best = machine_id;
+        }
+    }
+
+    if(best != NO_MACHINE) {
+        Request(best, S0);
+        claimed[best] = 1;
+        return true;
+    }
+
+    // Everything is up or on its way; the task waits for whichever compatible machine comes up
+    for(bool with_gpu : {false, true}) {
+        if(gpu && !with_gpu) {
+            continue;
+        }
+        for(MachineId_t machine_id : bucket_machines[BucketOf(cpu, with_gpu)]) {
+            if(IsWaking(machine_id) && machines.PlaceableMemory(machine_id) >= memory) {
+                claimed[machine_id]++;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool PowerManager::Serves(CPUType_t cpu, bool gpu) const {
+    return !bucket_machines[BucketOf(cpu, true)].empty() || (!gpu && !bucket_machines[BucketOf(cpu, false)].empty());
+}
+
+void PowerManager::StateChangeComplete(Time_t now, MachineId_t machine_id) {
+    in_transition[machine_id] = false;
+    claimed[machine_id] = 0;
+    if(machines.State(machine_id) != target_state[machine_id]) {
+        // Something else was asked for while this change was in flight
+        Request(machine_id, target_state[machine_id]);
+        return;
+    }
+    if(machines.IsReady(machine_id)) {
+        LOG("PowerManager::StateChangeComplete(): Machine " + to_string(machine_id) + " is up at time " + to_string(now), 3);
+        idle_since[machine_id] = now;
+        ScheduleParking(machine_id);
+    }
+}
+
+void PowerManager::PeriodicCheck(Time_t now) {
+    double elapsed = double(now - last_check) / 1000000;
+    last_check = now;
+    double decay = exp(-elapsed / RATE_WINDOW);
+    if(machines.PowerRevision() != power_revision) {
+        power_revision = machines.PowerRevision();
+        for(MachineId_t machine_id = 0; machine_id < machines.Total(); machine_id++) {
+            ScheduleParking(machine_id);
+        }
+    }
+
+    for(unsigned bucket = 0; bucket < 4 * 2; bucket++) {
+        if(elapsed > 0) {
+            arrival_rate[bucket] = arrival_rate[bucket] * decay + (arrivals[bucket] / elapsed) * (1 - decay);
+        }
+        arrivals[bucket] = 0;
+
+        // Spares are idle machines that are up or coming up
+        unsigned spares = 0;
+        candidates.clear();
+        for(MachineId_t machine_id : bucket_machines[bucket]) {
+            if(machines.ActiveTasks(machine_id) != 0 || machines.Incoming(machine_id) != 0) {
+                continue;
+            }
+            if(IsWaking(machine_id)) {
+                spares++;
+            }
+            else if(target_state[machine_id] == S0 && machines.IsReady(machine_id)) {
+                candidates.push_back(machine_id);
+            }
+        }
+        spares += candidates.size();
+
+        unsigned target = SpareTarget(bucket);
+        for(; spares < target; spares++) {
+            MachineId_t machine_id = Sleeper(bucket, 0);
+            if(machine_id == NO_MACHINE) {
+                break;
+            }
+            Request(machine_id, S0);
+        }
+
+        // Keep the most recently busy machines as spares and let the rest sleep
+        sort(candidates.begin(), candidates.end(), [&](MachineId_t a, MachineId_t b) { return idle_since[a] > idle_since[b]; });
+        for(unsigned i = min<size_t>(target, candidates.size()); i < candidates.size(); i++) {
+            MachineId_t machine_id = candidates[i];
+            if(now < park_due[machine_id]) {
+                continue;
+            }
+            MachineState_t state = ParkState(machine_id, now - idle_since[machine_id]);
+            if(state != S0) {
+                Request(machine_id, state);
+            }
+        }
+
+        // Parked machines go deeper the longer they stay idle
+        for(MachineId_t machine_id : bucket_machines[bucket]) {
+            MachineState_t current = target_state[machine_id];
+            if(current == S0 || in_transition[machine_id] || machines.ActiveTasks(machine_id) != 0 || now < park_due[machine_id]) {
+                continue;
+            }
+            MachineState_t state = ParkState(machine_id, now - idle_since[machine_id]);
+            if(state > current) {
+                Request(machine_id, state);
+            }
+        }
+    }
+}
+
+void PowerManager::Request(MachineId_t machine_id, MachineState_t state) {
+    target_state[machine_id] = state;
+    ScheduleParking(machine_id);
+    Trace(TRACE_S_STATE_REQUESTED, NO_TASK, NO_VM, machine_id, state);
+    if(in_transition[machine_id]) {
+        return;
+    }
+    in_transition[machine_id] = true;
+    // A machine going down stops taking work before it starts the transition
+    machines.BeginStateChange(machine_id, state);
+    placement.Update(machine_id);
+    LOG("PowerManager::Request(): Moving machine " + to_string(machine_id) + " to state " + to_string(state), 3);
+    Machine_SetState(machine_id, state);
+}
+
+// Parked machine in the bucket that can fit memory and comes back the fastest, or NO_MACHINE
+MachineId_t PowerManager::Sleeper(unsigned bucket, unsigned memory) const {
+    MachineId_t best = NO_MACHINE;
+    for(MachineId_t machine_id : bucket_machines[bucket]) {
+        if(target_state[machine_id] == S0 || machines.PlaceableMemory(machine_id) < memory) {
+            continue;
+        }
+        if(best == NO_MACHINE || wake_latency[target_state[machine_id]] < wake_latency[target_state[best]]) {
+            best = machine_id;
+        }
+    }
+    return best;
+}
+
+// Deepest parking state whose round trip the idle time so far would have paid for. Idle time seen
+// so far is the best guess of the idle time still to come.
+MachineState_t PowerManager::ParkState(MachineId_t machine_id, Time_t idle) const {
+    double awake_power = machines.IdlePower(machine_id, S0);
+    MachineState_t best = S0;
+    for(MachineState_t state : park_states) {
+        double saved = awake_power - machines.IdlePower(machine_id, state);
+        if(saved <= 0) {
+            continue;
+        }
+        double break_even = (enter_latency[state] + wake_latency[state]) * awake_power / saved;
+        if(idle >= break_even) {
+            best = state;
+        }
+    }
+    return best;
+}
+
+// ParkState() returns something deeper than the target state exactly once the idle time reaches
+// the smallest break-even among the deeper states, so that is when the machine needs a look again
+void PowerManager::ScheduleParking(MachineId_t machine_id) {
+    double awake_power = machines.IdlePower(machine_id, S0);
+    double due = HUGE_VAL;
+    for(MachineState_t state : park_states) {
+        double saved = awake_power - machines.IdlePower(machine_id, state);
+        if(state <= target_state[machine_id] || saved <= 0) {
+            continue;
+        }
+        due = min(due, (enter_latency[state] + wake_latency[state]) * awake_power / saved);
+    }
+    park_due[machine_id] = due == HUGE_VAL ? Time_t(-1) : idle_since[machine_id] + Time_t(ceil(due));
+}
+
+unsigned PowerManager::SpareTarget(unsigned bucket) const {
+    // Round up, but let a rate that has decayed to almost nothing release the last spare
+    double spares = arrival_rate[bucket] * SPARE_HORIZON / TASKS_PER_MACHINE;
+    return unsigned(ceil(spares - 0.01));
+}
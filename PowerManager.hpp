@@ -0,0 +1,79 @@
+//
+//  PowerManager.hpp
+//  CloudSim
+//
+
+#ifndef PowerManager_hpp
+#define PowerManager_hpp
+
+#include <vector>
+
+#include "MachineShadow.hpp"
+#include "PlacementIndex.hpp"
+#include "SimTypes.h"
+
+// Parks idle machines and wakes them when work shows up again.
+//
+// A machine that has run out of tasks starts an idle clock. Once it has been idle long enough to
+// pay for a round trip into a sleep state (the energy saved against S0 idle has to cover the
+// transition time at S0 power), it is parked in the deepest of S0i1, S3 and S5 that pays off, and
+// pushed deeper as the idle time grows. Each machine bucket (CPU type, GPU) keeps a few idle
+// machines in S0 as hot spares so bursts land right away; the pool is sized from the bucket's
+// recent arrival rate and topped up by waking the machines that sleep the shallowest.
+//
+// A machine with migrations on their way in is never parked. Idle and parked machines are not
+// re-evaluated every check: the idle time at which a deeper state starts paying off is worked out
+// in closed form whenever the idle clock or the target state moves, and nothing is looked at before.
+//
+// The simulator only accepts one state change per machine at a time, so a request made while
+// another is in flight is remembered and issued from StateChangeComplete().
+class PowerManager {
+public:
+    PowerManager(MachineShadow & machines, PlacementIndex & placement) : machines(machines), placement(placement) {}
+
+    void Init();
+    // Count an arrival toward the spare pool of the bucket the task needs
+    void RecordArrival(CPUType_t cpu, bool gpu);
+    // A task finished on the machine or a VM migrated off it; start its idle clock if it has
+    // nothing left to run
+    void LoadDropped(Time_t now, MachineId_t machine_id);
+    // Wake a parked machine that could take the task. Returns false if no such machine exists
+    // (awake or not), true if one is on its way up.
+    bool Wake(CPUType_t cpu, bool gpu, unsigned memory);
+    // Whether any machine, in whatever state, can run a task with these needs
+    bool Serves(CPUType_t cpu, bool gpu) const;
+    // Expects the shadow to be refreshed already
+    void StateChangeComplete(Time_t now, MachineId_t machine_id);
+    void PeriodicCheck(Time_t now);
+
+    bool IsWaking(MachineId_t machine_id) const     { return in_transition[machine_id] && target_state[machine_id] == S0; }
+private:
+    static unsigned BucketOf(CPUType_t cpu, bool gpu)   { return unsigned(cpu) * 2 + gpu; }
+
+    void Request(MachineId_t machine_id, MachineState_t state);
+    MachineId_t Sleeper(unsigned bucket, unsigned memory) const;
+    MachineState_t ParkState(MachineId_t machine_id, Time_t idle) const;
+    void ScheduleParking(MachineId_t machine_id);
+    unsigned SpareTarget(unsigned bucket) const;
+
+    MachineShadow & machines;
+    PlacementIndex & placement;
+
+    // Per machine
+    vector<Time_t> idle_since;
+    vector<Time_t> park_due;                // When ParkState() next picks a state deeper than target_state
+    vector<MachineState_t> target_state;    // Last state asked for; S0 while the machine should be up
+    vector<char> in_transition;
+    vector<unsigned> claimed;               // Queued tasks waiting for this machine to come up
+
+    // Per bucket
+    vector<MachineId_t> bucket_machines[4 * 2];
+    double arrival_rate[4 * 2] = {};        // Tasks per second, smoothed
+    unsigned arrivals[4 * 2] = {};          // Since the last check
+    Time_t last_check = 0;
+    unsigned power_revision = 0;            // Of the shadow's power tables park_due was computed from
+
+    vector<MachineId_t> candidates;         // Scratch space for PeriodicCheck
+};
+
+#endif /* PowerManager_hpp */
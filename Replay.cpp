@@ -0,0 +1,102 @@
+//
+//  Replay.cpp
+//  CloudSim
+//
+
+#include "Replay.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Interfaces.h"
+#include "Internal_Interfaces.h"
+#include "Log.hpp"
+#include "Scheduler.hpp"
+
+// Environment variable naming the workload file to replay
+#define REPLAY_VARIABLE "CLOUDSIM_REPLAY"
+// Arrivals handed to the simulator ahead of time, and the level at which the window is topped up
+#define REPLAY_WINDOW   4096
+#define REPLAY_REFILL   (REPLAY_WINDOW / 4)
+
+static_assert(sizeof(ReplayRecord_t) == 32, "workload records are mapped from disk as is");
+
+static const char replay_magic[8] = { 'C', 'S', 'R', 'E', 'P', 'L', 'A', 'Y' };
+
+WorkloadReplay::~WorkloadReplay() {
+    if(records != nullptr) {
+        munmap(const_cast<ReplayRecord_t *>(records) - 1, mapped_size);
+    }
+}
+
+void WorkloadReplay::Init(Scheduler & scheduler) {
+    const char * replay_path = getenv(REPLAY_VARIABLE);
+    if(replay_path == nullptr || *replay_path == '\0') {
+        return;
+    }
+    path = replay_path;
+    int fd = open(replay_path, O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0) {
+        ThrowException("WorkloadReplay::Init(): Cannot open ", path);
+    }
+    mapped_size = size_t(info.st_size);
+    void * mapping = mapped_size >= sizeof(ReplayRecord_t) ? mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        ThrowException("WorkloadReplay::Init(): Cannot map ", path);
+    }
+    madvise(mapping, mapped_size, MADV_SEQUENTIAL);
+
+    // The header is the size of one record, so the records start right after it
+    const char * header = static_cast<const char *>(mapping);
+    memcpy(&total, header + sizeof(replay_magic), sizeof(total));
+    if(memcmp(header, replay_magic, sizeof(replay_magic)) != 0 || total > mapped_size / sizeof(ReplayRecord_t) - 1) {
+        munmap(mapping, mapped_size);
+        ThrowException("WorkloadReplay::Init(): Not a workload file, or a truncated one: ", path);
+    }
+    records = static_cast<const ReplayRecord_t *>(mapping) + 1;
+    first_task = GetNumTasks();
+    LOG("WorkloadReplay::Init(): Replaying " + to_string(total) + " tasks from " + path, 1);
+    Refill(scheduler);
+}
+
+void WorkloadReplay::TaskArrived(Scheduler & scheduler, TaskId_t task_id) {
+    if(records == nullptr || task_id < first_task) {
+        return;
+    }
+    outstanding--;
+    if(outstanding < REPLAY_REFILL) {
+        Refill(scheduler);
+    }
+}
+
+void WorkloadReplay::Refill(Scheduler & scheduler) {
+    uint64_t start = next;
+    for(; next < total && outstanding < REPLAY_WINDOW; next++, outstanding++) {
+        const ReplayRecord_t & record = records[next];
+        if(record.arrival < last_arrival || record.arrival < Now()) {
+            ThrowException("WorkloadReplay::Refill(): Arrivals out of order at record ", unsigned(next));
+        }
+        last_arrival = record.arrival;
+        // AddTask() queues the arrival as well
+        AddTask(record.instructions, record.arrival, record.deadline, VMType_t(record.vm_type), SLAType_t(record.sla),
+                CPUType_t(record.cpu), record.gpu != 0, record.memory, WEB_REQUEST);
+    }
+    if(next == start) {
+        return;
+    }
+    scheduler.TasksAdded(GetNumTasks());
+
+    // Records behind the window are done with; let the kernel drop their pages
+    long page = sysconf(_SC_PAGESIZE);
+    uintptr_t base = reinterpret_cast<uintptr_t>(records - 1);
+    uintptr_t done = (reinterpret_cast<uintptr_t>(records + start) - base) / page * page;
+    if(done > 0) {
+        madvise(reinterpret_cast<void *>(base), done, MADV_DONTNEED);
+    }
+}
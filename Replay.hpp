@@ -0,0 +1,56 @@
+//
+//  Replay.hpp
+//  CloudSim
+//
+
+#ifndef Replay_hpp
+#define Replay_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "SimTypes.h"
+
+class Scheduler;
+
+// Replays recorded task arrivals instead of, or on top of, the input file's statistical task
+// classes. CLOUDSIM_REPLAY names a binary workload file (replay_import.py makes one from CSV); the
+// input file still describes the machines. The file is memory mapped and fed to the simulator in
+// windows: only the next REPLAY_WINDOW arrivals are ever handed to the simulator, and the window is
+// topped up as tasks arrive, so a trace of millions of tasks is never read in all at once.
+//
+// File layout, little endian: "CSREPLAY", a uint64_t record count, then records sorted by arrival.
+struct ReplayRecord_t {
+    Time_t arrival;
+    Time_t deadline;                        // Absolute, as TaskInfo_t::target_completion
+    uint64_t instructions;
+    uint32_t memory;                        // MB
+    uint8_t vm_type;                        // VMType_t
+    uint8_t cpu;                            // CPUType_t
+    uint8_t sla;                            // SLAType_t
+    uint8_t gpu;                            // 1 if the task can use a GPU
+};
+
+class WorkloadReplay {
+public:
+    ~WorkloadReplay();
+
+    // Maps the file if CLOUDSIM_REPLAY is set and hands the simulator the first window
+    void Init(Scheduler & scheduler);
+    // Called for every arrival, replayed or not; tops the window up when it runs low
+    void TaskArrived(Scheduler & scheduler, TaskId_t task_id);
+private:
+    void Refill(Scheduler & scheduler);
+
+    string path;
+    const ReplayRecord_t * records = nullptr;
+    size_t mapped_size = 0;
+    uint64_t total = 0;
+    TaskId_t first_task = 0;                // Simulator id of the first replayed task
+    uint64_t next = 0;                      // First record not handed to the simulator yet
+    uint64_t outstanding = 0;               // Handed over, not arrived yet
+    Time_t last_arrival = 0;
+};
+
+#endif /* Replay_hpp */
@@ -0,0 +1,118 @@
+//
+//  ReverseIndex.cpp
+//  CloudSim
+//
+
+#include "ReverseIndex.hpp"
+
+void ReverseIndex::Init(unsigned num_tasks, unsigned num_machines) {
+    task_vm.assign(num_tasks, NO_VM);
+    task_prev.assign(num_tasks, NO_TASK);
+    task_next.assign(num_tasks, NO_TASK);
+    machine_first_vm.assign(num_machines, NO_VM);
+    machine_vm_count.assign(num_machines, 0);
+}
+
+void ReverseIndex::GrowTasks(unsigned num_tasks) {
+    if(num_tasks > task_vm.size()) {
+        task_vm.resize(num_tasks, NO_VM);
+        task_prev.resize(num_tasks, NO_TASK);
+        task_next.resize(num_tasks, NO_TASK);
+    }
+}
+
+void ReverseIndex::AddVM(VMId_t vm_id, MachineId_t machine_id) {
+    if(vm_id >= vm_machine.size()) {
+        vm_machine.resize(vm_id + 1, NO_MACHINE);
+        vm_prev.resize(vm_id + 1, NO_VM);
+        vm_next.resize(vm_id + 1, NO_VM);
+        vm_first_task.resize(vm_id + 1, NO_TASK);
+        vm_task_count.resize(vm_id + 1, 0);
+    }
+    vm_first_task[vm_id] = NO_TASK;
+    vm_task_count[vm_id] = 0;
+    LinkVM(vm_id, machine_id);
+}
+
+void ReverseIndex::RemoveVM(VMId_t vm_id) {
+    if(vm_id >= vm_machine.size() || vm_machine[vm_id] == NO_MACHINE) {
+        return;
+    }
+    // Shutting down a VM with tasks is an error in the simulator, but drop any stragglers anyway
+    while(vm_first_task[vm_id] != NO_TASK) {
+        RemoveTask(vm_first_task[vm_id]);
+    }
+    UnlinkVM(vm_id);
+    vm_machine[vm_id] = NO_MACHINE;
+}
+
+void ReverseIndex::MoveVM(VMId_t vm_id, MachineId_t machine_id) {
+    UnlinkVM(vm_id);
+    LinkVM(vm_id, machine_id);
+}
+
+void ReverseIndex::AddTask(TaskId_t task_id, VMId_t vm_id) {
+    if(task_id >= task_vm.size()) {
+        task_vm.resize(task_id + 1, NO_VM);
+        task_prev.resize(task_id + 1, NO_TASK);
+        task_next.resize(task_id + 1, NO_TASK);
+    }
+    if(task_vm[task_id] != NO_VM) {
+        RemoveTask(task_id);
+    }
+    task_vm[task_id] = vm_id;
+    task_prev[task_id] = NO_TASK;
+    task_next[task_id] = vm_first_task[vm_id];
+    if(vm_first_task[vm_id] != NO_TASK) {
+        task_prev[vm_first_task[vm_id]] = task_id;
+    }
+    vm_first_task[vm_id] = task_id;
+    vm_task_count[vm_id]++;
+}
+
+void ReverseIndex::RemoveTask(TaskId_t task_id) {
+    VMId_t vm_id = VMOf(task_id);
+    if(vm_id == NO_VM) {
+        return;
+    }
+    if(task_prev[task_id] != NO_TASK) {
+        task_next[task_prev[task_id]] = task_next[task_id];
+    }
+    else {
+        vm_first_task[vm_id] = task_next[task_id];
+    }
+    if(task_next[task_id] != NO_TASK) {
+        task_prev[task_next[task_id]] = task_prev[task_id];
+    }
+    task_vm[task_id] = NO_VM;
+    task_prev[task_id] = NO_TASK;
+    task_next[task_id] = NO_TASK;
+    vm_task_count[vm_id]--;
+}
+
+void ReverseIndex::LinkVM(VMId_t vm_id, MachineId_t machine_id) {
+    vm_machine[vm_id] = machine_id;
+    vm_prev[vm_id] = NO_VM;
+    vm_next[vm_id] = machine_first_vm[machine_id];
+    if(machine_first_vm[machine_id] != NO_VM) {
+        vm_prev[machine_first_vm[machine_id]] = vm_id;
+    }
+    machine_first_vm[machine_id] = vm_id;
+    machine_vm_count[machine_id]++;
+}
+
+void ReverseIndex::UnlinkVM(VMId_t vm_id) {
+    MachineId_t machine_id = vm_machine[vm_id];
+    if(vm_prev[vm_id] != NO_VM) {
+        vm_next[vm_prev[vm_id]] = vm_next[vm_id];
+    }
+    else {
+        machine_first_vm[machine_id] = vm_next[vm_id];
+    }
+    if(vm_next[vm_id] != NO_VM) {
+        vm_prev[vm_next[vm_id]] = vm_prev[vm_id];
+    }
+    vm_prev[vm_id] = NO_VM;
+    vm_next[vm_id] = NO_VM;
+    machine_vm_count[machine_id]--;
+}
@@ -0,0 +1,66 @@
+//
+//  ReverseIndex.hpp
+//  CloudSim
+//
+
+#ifndef ReverseIndex_hpp
+#define ReverseIndex_hpp
+
+#include <vector>
+
+#include "SimTypes.h"
+
+#define NO_TASK    TaskId_t(-1)
+#define NO_VM      VMId_t(-1)
+#define NO_MACHINE MachineId_t(-1)
+
+// Who runs where, as seen by the scheduler: task -> VM, VM -> machine, and the reverse lists
+// machine -> VMs and VM -> tasks. Everything is stored in arrays indexed by id, and the reverse
+// lists are intrusive doubly linked lists threaded through those arrays, so adding, removing and
+// walking never allocates and never needs VM_GetInfo() to copy a VM's task list.
+//
+// Walk a list like this:
+//     for(TaskId_t task_id = index.FirstTask(vm_id); task_id != NO_TASK; task_id = index.NextTask(task_id))
+class ReverseIndex {
+public:
+    void Init(unsigned num_tasks, unsigned num_machines);
+    // Tasks can be added while the simulation runs; ids stay dense
+    void GrowTasks(unsigned num_tasks);
+
+    void AddVM(VMId_t vm_id, MachineId_t machine_id);
+    void RemoveVM(VMId_t vm_id);
+    void MoveVM(VMId_t vm_id, MachineId_t machine_id);
+    void AddTask(TaskId_t task_id, VMId_t vm_id);
+    void RemoveTask(TaskId_t task_id);
+
+    VMId_t VMOf(TaskId_t task_id) const             { return task_id < task_vm.size() ? task_vm[task_id] : NO_VM; }
+    MachineId_t MachineOf(VMId_t vm_id) const       { return vm_machine[vm_id]; }
+    unsigned TaskCount(VMId_t vm_id) const          { return vm_task_count[vm_id]; }
+    unsigned VMCount(MachineId_t machine_id) const  { return machine_vm_count[machine_id]; }
+
+    TaskId_t FirstTask(VMId_t vm_id) const          { return vm_first_task[vm_id]; }
+    TaskId_t NextTask(TaskId_t task_id) const       { return task_next[task_id]; }
+    VMId_t FirstVM(MachineId_t machine_id) const    { return machine_first_vm[machine_id]; }
+    VMId_t NextVM(VMId_t vm_id) const               { return vm_next[vm_id]; }
+private:
+    void LinkVM(VMId_t vm_id, MachineId_t machine_id);
+    void UnlinkVM(VMId_t vm_id);
+
+    // Per task
+    vector<VMId_t> task_vm;
+    vector<TaskId_t> task_prev;
+    vector<TaskId_t> task_next;
+
+    // Per VM
+    vector<MachineId_t> vm_machine;
+    vector<VMId_t> vm_prev;
+    vector<VMId_t> vm_next;
+    vector<TaskId_t> vm_first_task;
+    vector<unsigned> vm_task_count;
+
+    // Per machine
+    vector<VMId_t> machine_first_vm;
+    vector<unsigned> machine_vm_count;
+};
+
+#endif /* ReverseIndex_hpp */
@@ -0,0 +1,387 @@
+// Scheduler.cpp
+// CloudSim
+//
+// Created by ELMOOTAZBELLAH ELNOZAHY on 10/20/24.
+//
+
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Trace.hpp"
+#include "UpcallTimer.hpp"
+#include "Scheduler.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+// Environment variable that selects the policy at startup
+#define POLICY_VARIABLE "CLOUDSIM_POLICY"
+#define DEFAULT_POLICY  "best"
+
+Priority_t SLAPriority(SLAType_t sla) {
+    // Set priority based on SLA with SLA2 elevated to balance all SLAs up to 80%
+    switch(sla) {
+        case SLA0:
+            return HIGH_PRIORITY; // Highest priority for SLA0
+        case SLA1:
+        case SLA2:
+            return MID_PRIORITY;  // Medium priority for SLA1 and SLA2
+        default:
+            return LOW_PRIORITY;  // Low priority for SLA3
+    }
+}
+
+Time_t SLADeadline(const TaskInfo_t & task_info) {
+    // The simulator hands out the deadline itself: the runtime at 1000 MIPS plus an SLA dependent
+    // slack, counted from arrival. A task finishing after it violates its SLA.
+    return task_info.target_completion;
+}
+
+MachineId_t Scheduler::FindLessLoadedMachine(MachineId_t current_machine) const {
+    MachineId_t best_machine = current_machine;
+    unsigned min_tasks = UINT_MAX;
+
+    for (MachineId_t machine_id : machines) {
+        unsigned active_tasks = machine_shadow.ActiveTasks(machine_id);
+
+        if (machine_id != current_machine && active_tasks < min_tasks) {
+            min_tasks = active_tasks;
+            best_machine = machine_id;
+        }
+    }
+
+    return best_machine;
+}
+
+void Scheduler::Init() {
+    // Pick the policy before touching anything else so a typo fails fast
+    const char * policy_name = getenv(POLICY_VARIABLE);
+    string name = policy_name != nullptr ? policy_name : DEFAULT_POLICY;
+    policy = CreatePolicy(name);
+    if(policy == nullptr) {
+        ThrowException("Scheduler::Init(): Unknown policy " + name + ", expected one of ", PolicyNames());
+    }
+
+    // Get actual number of machines from the system
+    unsigned total_machines = Machine_GetTotal();
+
+    LOG("Scheduler::Init(): Total number of machines is " + to_string(total_machines), 3);
+    LOG("Scheduler::Init(): Initializing scheduler with policy " + name, 1);
+
+    // Capture machine specs once; placement reads them from the shadow from here on
+    machine_shadow.Init();
+    DecisionTrace::Init();
+    reverse_index.Init(GetNumTasks(), total_machines);
+    power_manager.Init();
+    governor.Init();
+    consolidator.Init();
+    completion_model.Init(GetNumTasks());
+    memory_guard.Init();
+    deadline_tracker.Init(GetNumTasks());
+
+    // Populate 'machines' vector with all MachineId_t
+    for(unsigned i = 0; i < total_machines; i++) {
+        MachineId_t machine_id = i;
+        machines.push_back(machine_id);
+        placement_index.AddMachine(machine_id);
+    }
+
+    // Every machine keeps one VM of its native type for good: placement only finds machines through
+    // their VMs. VMs of other types, and extra ones, come and go with the tasks (VMPool).
+    for(auto machine_id : machines) {
+        CPUType_t cpu = machine_shadow.CPU(machine_id);
+        VMType_t vm_type = (cpu == POWER) ? AIX : LINUX;
+        vm_pool.Pin(CreateVM(vm_type, cpu, machine_id));
+    }
+
+    // Recorded arrivals, if any, go in once everything is ready for them
+    replay.Init(*this);
+}
+
+void Scheduler::AddTask(TaskId_t task_id, VMId_t vm_id, Priority_t priority, unsigned memory) {
+    priority = deadline_tracker.Admit(Now(), task_id, priority);
+    VM_AddTask(vm_id, task_id, priority);
+    placement_index.AddTask(task_id, vm_id, memory);
+    completion_model.TaskPlaced(Now(), task_id);
+    Trace(TRACE_TASK_PLACED, task_id, vm_id, reverse_index.MachineOf(vm_id), priority, completion_model.Predicted(task_id));
+}
+
+VMId_t Scheduler::CreateVM(VMType_t vm_type, CPUType_t cpu, MachineId_t machine_id) {
+    VMId_t vm_id = VM_Create(vm_type, cpu);
+    VM_Attach(vm_id, machine_id);
+    vms.push_back(vm_id);
+    placement_index.AddVM(vm_id, vm_type, machine_id);
+    vm_pool.Created(Now(), vm_id);
+    Trace(TRACE_VM_CREATED, NO_TASK, vm_id, machine_id, vm_type);
+    LOG("Scheduler::CreateVM(): VM " + to_string(vm_id) + " created and attached to Machine " + to_string(machine_id), 3);
+    return vm_id;
+}
+
+VMId_t Scheduler::ProvideVM(VMType_t vm_type, CPUType_t cpu, MachineId_t machine_id) {
+    VMId_t vm_id = vm_pool.Reuse(*this, vm_type, machine_id);
+    return vm_id != NO_VM ? vm_id : CreateVM(vm_type, cpu, machine_id);
+}
+
+void Scheduler::ShutdownVM(VMId_t vm_id) {
+    auto position = find(vms.begin(), vms.end(), vm_id);
+    if(position == vms.end()) {
+        return;
+    }
+    VM_Shutdown(vm_id);
+    placement_index.RemoveVM(vm_id);
+    *position = vms.back();
+    vms.pop_back();
+}
+
+void Scheduler::MigrateVM(VMId_t vm_id, MachineId_t machine_id) {
+    LOG("Scheduler::MigrateVM(): Migrating VM " + to_string(vm_id) + " from machine " + to_string(reverse_index.MachineOf(vm_id)) + " to machine " + to_string(machine_id), 3);
+    VM_Migrate(vm_id, machine_id);
+    migrating_vms[vm_id] = machine_id;
+    Trace(TRACE_MIGRATION_STARTED, NO_TASK, vm_id, machine_id, 0, reverse_index.MachineOf(vm_id));
+    placement_index.BeginMigration(vm_id, machine_id);
+}
+
+void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
+    replay.TaskArrived(*this, task_id);
+    CPUType_t cpu = RequiredCPUType(task_id);
+    bool gpu = IsTaskGPUCapable(task_id);
+    power_manager.RecordArrival(cpu, gpu);
+    if(DecisionTrace::enabled) {
+        TaskInfo_t task_info = GetTaskInfo(task_id);
+        Trace(TRACE_TASK_ARRIVED, task_id, NO_VM, NO_MACHINE, task_info.required_sla, SLADeadline(task_info));
+    }
+
+    if(policy->PlaceTask(*this, now, task_id)) {
+        governor.TaskPlaced(now, reverse_index.MachineOf(reverse_index.VMOf(task_id)));
+        return;
+    }
+
+    // Nothing that is up can take it. Bring up a machine that can if one is asleep, and hold the task
+    // until room shows up, either on that machine or on one that is up already.
+    if(!power_manager.Wake(cpu, gpu, GetTaskMemory(task_id)) && !power_manager.Serves(cpu, gpu)) {
+        LOG("Scheduler::NewTask(): No machine can run task " + to_string(task_id) + " at time " + to_string(now), 1);
+        Trace(TRACE_TASK_DROPPED, task_id, NO_VM, NO_MACHINE);
+        return;
+    }
+    LOG("Scheduler::NewTask(): No room for task " + to_string(task_id) + " at time " + to_string(now) + ", queued", 3);
+    Trace(TRACE_TASK_QUEUED, task_id, NO_VM, NO_MACHINE);
+    pending_tasks.insert({SLADeadline(GetTaskInfo(task_id)), task_id});
+}
+
+// Retry the tasks that are waiting for room, the most urgent first
+void Scheduler::PlacePending(Time_t now) {
+    for(auto it = pending_tasks.begin(); it != pending_tasks.end();) {
+        TaskId_t task_id = it->second;
+        if(!policy->PlaceTask(*this, now, task_id)) {
+            it++;
+            continue;
+        }
+        it = pending_tasks.erase(it);
+        governor.TaskPlaced(now, reverse_index.MachineOf(reverse_index.VMOf(task_id)));
+    }
+}
+
+void Scheduler::MemoryWarning(Time_t now, MachineId_t machine_id) {
+    Trace(TRACE_MEMORY_WARNING, NO_TASK, NO_VM, machine_id);
+    memory_guard.MemoryWarning(*this, now, machine_id);
+    policy->MemoryWarning(*this, now, machine_id);
+}
+
+void Scheduler::MigrationComplete(Time_t time, VMId_t vm_id) {
+    auto migration = migrating_vms.find(vm_id);
+    if(migration == migrating_vms.end()) {
+        return;
+    }
+    MachineId_t source = reverse_index.MachineOf(vm_id);
+    MachineId_t target = migration->second;
+    migrating_vms.erase(migration);
+    Trace(TRACE_MIGRATION_DONE, NO_TASK, vm_id, target, 0, source);
+
+    // The VM (with its tasks and memory) now lives on its destination machine. The simulator keeps
+    // part of its memory charged to the source, so take both machines' memory from it.
+    placement_index.MoveVM(vm_id, target);
+    machine_shadow.RefreshMemory(source);
+    machine_shadow.RefreshMemory(target);
+    placement_index.Update(source);
+    placement_index.Update(target);
+    power_manager.LoadDropped(time, source);
+    memory_guard.LoadDropped(time, source);
+    PlacePending(time);
+}
+
+void Scheduler::PeriodicCheck(Time_t now) {
+    machine_shadow.Sample(now);
+    policy->PeriodicCheck(*this, now);
+    consolidator.PeriodicCheck(*this, now);
+    vm_pool.PeriodicCheck(*this, now);
+    deadline_tracker.PeriodicCheck(now);
+    power_manager.PeriodicCheck(now);
+    governor.PeriodicCheck(now);
+    DecisionTrace::Sample(now, false);
+}
+
+void Scheduler::Shutdown(Time_t time) {
+    // Do your final reporting and bookkeeping here.
+    // Report about the total energy consumed
+    // Report about the SLA compliance
+    // Shutdown everything to be tidy :-)
+    // Machines that are parked refuse to detach VMs, so leave theirs alone
+    for(auto & vm: vms) {
+        if(machine_shadow.IsReady(reverse_index.MachineOf(vm))) {
+            VM_Shutdown(vm);
+        }
+    }
+
+    if(!pending_tasks.empty()) {
+        LOG("Scheduler::Shutdown(): " + to_string(pending_tasks.size()) + " tasks were never placed", 1);
+    }
+
+    completion_model.Report();
+    memory_guard.Report(time);
+    vm_pool.Report();
+    deadline_tracker.Report();
+    DecisionTrace::Sample(time, true);
+    DecisionTrace::Close();
+
+    // How the governor spread the awake time over the P-states
+    Time_t p_state_time[P_STATES] = {};
+    Time_t awake_time = 0;
+    for(MachineId_t machine_id : machines) {
+        for(unsigned p = 0; p < P_STATES; p++) {
+            p_state_time[p] += governor.TimeInPState(machine_id, CPUPerformance_t(p));
+            awake_time += governor.TimeInPState(machine_id, CPUPerformance_t(p));
+        }
+    }
+    for(unsigned p = 0; p < P_STATES; p++) {
+        double share = awake_time > 0 ? 100.0 * p_state_time[p] / awake_time : 0;
+        LOG("Scheduler::Shutdown(): Time at P" + to_string(p) + " is " + to_string(share) + "% of awake machine time", 1);
+    }
+    LOG("SimulationComplete(): Finished!", 4);
+    LOG("SimulationComplete(): Time is " + to_string(time), 4);
+    AuditTrail::Write();
+}
+
+void Scheduler::SLAWarning(Time_t now, TaskId_t task_id) {
+    VMId_t vm_id = reverse_index.VMOf(task_id);
+    Trace(TRACE_SLA_WARNING, task_id, vm_id, vm_id != NO_VM ? reverse_index.MachineOf(vm_id) : NO_MACHINE);
+    if(vm_id != NO_VM) {
+        governor.SLAWarning(now, reverse_index.MachineOf(vm_id));
+        deadline_tracker.SLAWarning(now, task_id);
+    }
+    policy->SLAWarning(*this, now, task_id);
+}
+
+void Scheduler::StateChangeComplete(Time_t now, MachineId_t machine_id) {
+    // Only machines in S0 can take VMs and tasks, so only those are kept in the placement buckets
+    machine_shadow.Refresh(machine_id);
+    if(DecisionTrace::enabled) {
+        Trace(TRACE_S_STATE_DONE, NO_TASK, NO_VM, machine_id, machine_shadow.State(machine_id), Machine_GetEnergy(machine_id));
+    }
+    power_manager.StateChangeComplete(now, machine_id);
+    placement_index.Update(machine_id);
+    if(machine_shadow.IsReady(machine_id)) {
+        PlacePending(now);
+    }
+    policy->StateChangeComplete(*this, now, machine_id);
+}
+
+void Scheduler::TasksAdded(unsigned num_tasks) {
+    reverse_index.GrowTasks(num_tasks);
+    completion_model.GrowTasks(num_tasks);
+    deadline_tracker.GrowTasks(num_tasks);
+}
+
+void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
+    VMId_t vm_id = reverse_index.VMOf(task_id);
+    if(vm_id == NO_VM) {
+        return;
+    }
+
+    // Drops the task from its VM's list and starts the host's idle clock if it has nothing left, then
+    // gives the room it freed to a waiting task
+    MachineId_t machine_id = reverse_index.MachineOf(vm_id);
+    completion_model.TaskComplete(now, task_id);
+    deadline_tracker.TaskComplete(now, task_id);
+    Trace(TRACE_TASK_COMPLETED, task_id, vm_id, machine_id);
+    placement_index.RemoveTask(task_id, GetTaskMemory(task_id));
+    power_manager.LoadDropped(now, machine_id);
+    memory_guard.LoadDropped(now, machine_id);
+    PlacePending(now);
+}
+
+// Public interface below
+
+static Scheduler Scheduler;
+
+void InitScheduler() {
+    LOG("InitScheduler(): Initializing scheduler", 4);
+    AuditTrail::Init();
+    UpcallTiming::Start();
+    Scheduler.Init();
+}
+
+void HandleNewTask(Time_t time, TaskId_t task_id) {
+    TIME_UPCALL(UPCALL_NEW_TASK);
+    LOG("HandleNewTask(): Received new task " + to_string(task_id) + " at time " + to_string(time), 4);
+    Audit(AUDIT_NEW_TASK, time, task_id);
+    Scheduler.NewTask(time, task_id);
+}
+
+void HandleTaskCompletion(Time_t time, TaskId_t task_id) {
+    TIME_UPCALL(UPCALL_TASK_COMPLETE);
+    LOG("HandleTaskCompletion(): Task " + to_string(task_id) + " completed at time " + to_string(time), 4);
+    Audit(AUDIT_TASK_COMPLETE, time, task_id);
+    Scheduler.TaskComplete(time, task_id);
+}
+
+void MemoryWarning(Time_t time, MachineId_t machine_id) {
+    TIME_UPCALL(UPCALL_MEMORY_WARNING);
+    // The simulator is alerting you that machine identified by machine_id is overcommitted
+    LOG("MemoryWarning(): Overflow at " + to_string(machine_id) + " was detected at time " + to_string(time), 0);
+    Audit(AUDIT_MEMORY_WARNING, time, machine_id);
+    Scheduler.MemoryWarning(time, machine_id);
+}
+
+void MigrationDone(Time_t time, VMId_t vm_id) {
+    TIME_UPCALL(UPCALL_MIGRATION_DONE);
+    // Log migration completion
+    LOG("MigrationDone(): Migration of VM " + to_string(vm_id) + " completed at time " + to_string(time), 4);
+    Audit(AUDIT_MIGRATION_DONE, time, vm_id);
+
+    // Complete any additional migration steps (e.g., task updates)
+    Scheduler.MigrationComplete(time, vm_id);
+}
+
+void SchedulerCheck(Time_t time) {
+    TIME_UPCALL(UPCALL_SCHEDULER_CHECK);
+    // This function is called periodically by the simulator, no specific event
+    LOG("SchedulerCheck(): SchedulerCheck() called at " + to_string(time), 4);
+    Audit(AUDIT_SCHEDULER_CHECK, time, 0);
+    Scheduler.PeriodicCheck(time);
+}
+
+void SimulationComplete(Time_t time) {
+    // This function is called before the simulation terminates Add whatever you feel like.
+    cout << "SLA violation report" << endl;
+    cout << "SLA0: " << GetSLAReport(SLA0) << "%" << endl;
+    cout << "SLA1: " << GetSLAReport(SLA1) << "%" << endl;
+    cout << "SLA2: " << GetSLAReport(SLA2) << "%" << endl;     // SLA3 do not have SLA violation issues
+    cout << "Total Energy " << Machine_GetClusterEnergy() << "KW-Hour" << endl;
+    cout << "Simulation run finished in " << double(time)/1000000 << " seconds" << endl;
+    LOG("SimulationComplete(): Simulation finished at time " + to_string(time), 4);
+
+    Scheduler.Shutdown(time);
+    UpcallTiming::Report();
+}
+
+void SLAWarning(Time_t time, TaskId_t task_id) {
+    TIME_UPCALL(UPCALL_SLA_WARNING);
+    Audit(AUDIT_SLA_WARNING, time, task_id);
+    Scheduler.SLAWarning(time, task_id);
+}
+
+void StateChangeComplete(Time_t time, MachineId_t machine_id) {
+    TIME_UPCALL(UPCALL_STATE_CHANGE);
+    // Called in response to an earlier request to change the state of a machine
+    Audit(AUDIT_STATE_CHANGE, time, machine_id);
+    Scheduler.StateChangeComplete(time, machine_id);
+}
@@ -9,24 +9,94 @@
 #define Scheduler_hpp
 
 #include <limits.h>
+#include <set>
+#include <utility>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "CompletionModel.hpp"
+#include "Consolidator.hpp"
+#include "DeadlineTracker.hpp"
+#include "Governor.hpp"
+#include "MachineShadow.hpp"
+#include "MemoryGuard.hpp"
+#include "PlacementIndex.hpp"
+#include "Policy.hpp"
+#include "PowerManager.hpp"
+#include "Replay.hpp"
+#include "ReverseIndex.hpp"
+#include "VMPool.hpp"
 
+// SLA helpers shared by every policy
+Priority_t SLAPriority(SLAType_t sla);
+Time_t SLADeadline(const TaskInfo_t & task_info);
+
+// The scheduler core. It owns all the bookkeeping (machine shadow, placement and reverse indexes,
+// the VM list), the machine power states and clock speeds, consolidation by migration, the VM
+// lifecycle, and hands every placement decision to the policy selected at startup. Tasks that find
+// no room wait in a queue, earliest SLA deadline first, and are retried whenever room may have
+// appeared: a machine came up, a task finished or a migration landed.
 class Scheduler {
 public:
-    Scheduler()                 {}
+    Scheduler() : placement_index(machine_shadow, reverse_index), power_manager(machine_shadow, placement_index),
+                  governor(machine_shadow, placement_index, reverse_index), consolidator(machine_shadow, placement_index, reverse_index),
+                  completion_model(machine_shadow, reverse_index), memory_guard(machine_shadow, placement_index, reverse_index),
+                  vm_pool(machine_shadow, placement_index, reverse_index), deadline_tracker(reverse_index) {}
+    ~Scheduler()                                    { delete policy; }
     void Init();
+    void MemoryWarning(Time_t now, MachineId_t machine_id);
     void MigrationComplete(Time_t time, VMId_t vm_id);
     void NewTask(Time_t now, TaskId_t task_id);
     void PeriodicCheck(Time_t now);
     void Shutdown(Time_t now);
+    void SLAWarning(Time_t now, TaskId_t task_id);
+    void StateChangeComplete(Time_t now, MachineId_t machine_id);
     void TaskComplete(Time_t now, TaskId_t task_id);
+    // The simulator's task table grew while running, e.g. by a workload replay
+    void TasksAdded(unsigned num_tasks);
+
+    // Actions for policies; these keep the bookkeeping in step with the simulator. AddTask takes the
+    // priority the task's SLA calls for; the task may start below it (DeadlineTracker).
+    void AddTask(TaskId_t task_id, VMId_t vm_id, Priority_t priority, unsigned memory);
+    VMId_t CreateVM(VMType_t vm_type, CPUType_t cpu, MachineId_t machine_id);
+    // A VM of the type on the machine for a new task: an empty one already there, or a new one
+    VMId_t ProvideVM(VMType_t vm_type, CPUType_t cpu, MachineId_t machine_id);
+    void MigrateVM(VMId_t vm_id, MachineId_t machine_id);
+    // The VM has to be empty
+    void ShutdownVM(VMId_t vm_id);
+    MachineId_t FindLessLoadedMachine(MachineId_t current_machine) const;
+
+    // State for policies
+    const MachineShadow & Machines() const          { return machine_shadow; }
+    const PlacementIndex & Placement() const        { return placement_index; }
+    const ReverseIndex & Residency() const          { return reverse_index; }
+    const Governor & Clocks() const                 { return governor; }
+    const CompletionModel & Model() const           { return completion_model; }
+    const DeadlineTracker & Deadlines() const       { return deadline_tracker; }
+    const vector<MachineId_t> & MachineIds() const  { return machines; }
+    bool IsMigrating(VMId_t vm_id) const            { return migrating_vms.count(vm_id) != 0; }
 private:
+    void PlacePending(Time_t now);
+
     vector<VMId_t> vms;
     vector<MachineId_t> machines;
+    unordered_map<VMId_t, MachineId_t> migrating_vms;   // VM -> destination
+    MachineShadow machine_shadow;
+    ReverseIndex reverse_index;
+    PlacementIndex placement_index;
+    PowerManager power_manager;
+    Governor governor;
+    Consolidator consolidator;
+    CompletionModel completion_model;
+    MemoryGuard memory_guard;
+    VMPool vm_pool;
+    DeadlineTracker deadline_tracker;
+    WorkloadReplay replay;
+    set<pair<Time_t, TaskId_t>> pending_tasks;         // (SLA deadline, task), earliest first
+    Policy * policy = nullptr;
 };
 
 
 
-#endif /* Scheduler_hpp */
\ No newline at end of file
+#endif /* Scheduler_hpp */
@@ -0,0 +1,417 @@
+//
+//  Tests.cpp
+//  CloudSim
+//
+// Scenario tests of the scheduler core: each case builds a small cluster in FakeSimulator, drives a
+// fresh Scheduler through scripted upcalls and checks its bookkeeping against the fake's state.
+// The whole run takes milliseconds.
+//
+//     make test
+//     ./tests [case ...]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "FakeSimulator.hpp"
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Scheduler.hpp"
+
+// Tasks in the scenarios run for about a third of a second at full speed and have time to spare
+#define TASK_SIZE       1000000000ull
+#define TASK_DEADLINE   60000000
+#define TASK_MEMORY     512
+// Kept short so a scenario never waits long on the fake's clock
+#define STATE_LATENCY   1000000
+#define MIGRATION_TIME  2000000
+// The fake's default check period
+#define CHECK_PERIOD    60000
+
+static bool passed;
+
+#define EXPECT(condition)   Expect(condition, #condition, __LINE__)
+
+static void Expect(bool condition, const char * text, int line) {
+    if(!condition) {
+        printf("    line %d: %s\n", line, text);
+        passed = false;
+    }
+}
+
+static TaskId_t AddTask(Time_t arrival, CPUType_t cpu) {
+    return FakeSimulator::AddTask(arrival, TASK_SIZE, arrival + TASK_DEADLINE, cpu == POWER ? AIX : LINUX, SLA1, cpu, false, TASK_MEMORY);
+}
+
+// A fresh scheduler for the cluster and tasks already added to the fake, taking its upcalls
+static Scheduler * Start() {
+    setenv("CLOUDSIM_POLICY", "best", 1);
+    FakeSimulator::SetStateChangeLatency(STATE_LATENCY);
+    FakeSimulator::SetMigrationTime(MIGRATION_TIME);
+    Scheduler * scheduler = new Scheduler();
+    FakeSimulator::Attach(scheduler);
+    scheduler->Init();
+    return scheduler;
+}
+
+static MachineId_t HostOf(const Scheduler & scheduler, TaskId_t task_id) {
+    VMId_t vm_id = scheduler.Residency().VMOf(task_id);
+    return vm_id != NO_VM ? scheduler.Residency().MachineOf(vm_id) : NO_MACHINE;
+}
+
+// The shadow agrees with the simulator on what the machine holds
+static void ExpectInStep(const Scheduler & scheduler, MachineId_t machine_id) {
+    MachineInfo_t info = Machine_GetInfo(machine_id);
+    EXPECT(scheduler.Machines().MemoryUsed(machine_id) == info.memory_used);
+    EXPECT(scheduler.Machines().ActiveTasks(machine_id) == info.active_tasks);
+}
+
+static void PlacedOnAwakeMachine() {
+    MachineId_t x86 = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    FakeSimulator::AddMachine(ARM, 8, 16384, false);
+    TaskId_t task_id = AddTask(1000, X86);
+    Scheduler * scheduler = Start();
+
+    FakeSimulator::InjectArrivals();
+    FakeSimulator::Advance(1000);
+    EXPECT(HostOf(*scheduler, task_id) == x86);
+    EXPECT(Machine_GetInfo(x86).s_state == S0);
+    EXPECT(scheduler->Machines().IsReady(x86));
+    EXPECT(VM_GetInfo(scheduler->Residency().VMOf(task_id)).active_tasks.size() == 1);
+    ExpectInStep(*scheduler, x86);
+    delete scheduler;
+}
+
+static void QueuedUntilMachineWakes() {
+    FakeSimulator::AddMachine(X86, 8, 16384, false);
+    MachineId_t arm = FakeSimulator::AddMachine(ARM, 8, 16384, false);
+    // Long enough for the idle ARM machine to be parked
+    TaskId_t task_id = AddTask(300000000, ARM);
+    Scheduler * scheduler = Start();
+
+    FakeSimulator::Advance(300000000 - 1);
+    EXPECT(!scheduler->Machines().IsReady(arm));
+
+    FakeSimulator::InjectArrivals();
+    FakeSimulator::Advance(300000000);
+    EXPECT(HostOf(*scheduler, task_id) == NO_MACHINE);
+
+    FakeSimulator::Advance(300000000 + 2 * STATE_LATENCY);
+    EXPECT(scheduler->Machines().IsReady(arm));
+    EXPECT(HostOf(*scheduler, task_id) == arm);
+    ExpectInStep(*scheduler, arm);
+    delete scheduler;
+}
+
+static void MigrationKeepsShadowInStep() {
+    MachineId_t source = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    MachineId_t target = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    vector<TaskId_t> task_ids;
+    for(unsigned i = 0; i < 3; i++) {
+        task_ids.push_back(AddTask(1000, X86));
+    }
+    // No checks, so the consolidator does not move anything on its own
+    FakeSimulator::SetCheckPeriod(0);
+    Scheduler * scheduler = Start();
+
+    FakeSimulator::InjectArrivals();
+    FakeSimulator::Advance(1000);
+    VMId_t vm_id = scheduler->Residency().VMOf(task_ids[0]);
+    if(scheduler->Residency().MachineOf(vm_id) != source) {
+        swap(source, target);
+    }
+    unsigned moved = scheduler->Residency().TaskCount(vm_id);
+    unsigned on_source = Machine_GetInfo(source).active_tasks;
+    unsigned on_target = Machine_GetInfo(target).active_tasks;
+    scheduler->MigrateVM(vm_id, target);
+    EXPECT(scheduler->IsMigrating(vm_id));
+
+    FakeSimulator::Advance(1000 + MIGRATION_TIME);
+    EXPECT(!scheduler->IsMigrating(vm_id));
+    EXPECT(scheduler->Residency().MachineOf(vm_id) == target);
+    EXPECT(scheduler->Placement().HostOf(vm_id) == target);
+    EXPECT(VM_GetInfo(vm_id).machine_id == target);
+    EXPECT(Machine_GetInfo(source).active_tasks == on_source - moved);
+    EXPECT(Machine_GetInfo(target).active_tasks == on_target + moved);
+    ExpectInStep(*scheduler, source);
+    ExpectInStep(*scheduler, target);
+    delete scheduler;
+}
+
+static void CompletionDuringMigration() {
+    MachineId_t source = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    MachineId_t target = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    TaskId_t staying = AddTask(0, X86);
+    TaskId_t leaving = AddTask(0, X86);
+    FakeSimulator::SetCheckPeriod(0);
+    Scheduler * scheduler = Start();
+
+    // Both on the source's VM; the tasks stop while it migrates, so the completion waits for it to land
+    VMId_t vm_id = scheduler->Residency().FirstVM(source);
+    scheduler->AddTask(staying, vm_id, MID_PRIORITY, TASK_MEMORY);
+    scheduler->AddTask(leaving, vm_id, MID_PRIORITY, TASK_MEMORY);
+    scheduler->MigrateVM(vm_id, target);
+    FakeSimulator::InjectTaskCompletion(MIGRATION_TIME / 2, leaving);
+
+    FakeSimulator::Advance(MIGRATION_TIME);
+    EXPECT(HostOf(*scheduler, staying) == target);
+    EXPECT(HostOf(*scheduler, leaving) == target);
+    EXPECT(Machine_GetInfo(target).active_tasks == 2);
+    ExpectInStep(*scheduler, source);
+    ExpectInStep(*scheduler, target);
+
+    FakeSimulator::Advance(MIGRATION_TIME + MIGRATION_TIME / 2);
+    EXPECT(IsTaskCompleted(leaving));
+    EXPECT(scheduler->Residency().TaskCount(vm_id) == 1);
+    EXPECT(Machine_GetInfo(target).active_tasks == 1);
+    ExpectInStep(*scheduler, source);
+    ExpectInStep(*scheduler, target);
+    delete scheduler;
+}
+
+static void MemoryWarningEvacuates() {
+    MachineId_t source = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    MachineId_t target = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    TaskId_t task_id = AddTask(1000, X86);
+    FakeSimulator::SetCheckPeriod(0);
+    Scheduler * scheduler = Start();
+
+    FakeSimulator::InjectArrivals();
+    FakeSimulator::Advance(1000);
+    VMId_t vm_id = scheduler->Residency().VMOf(task_id);
+    if(scheduler->Residency().MachineOf(vm_id) != source) {
+        swap(source, target);
+    }
+    FakeSimulator::InjectMemoryWarning(2000, source);
+    FakeSimulator::Advance(2000);
+    EXPECT(scheduler->Machines().IsMemoryBlocked(source));
+    EXPECT(scheduler->IsMigrating(vm_id));
+
+    FakeSimulator::Advance(2000 + MIGRATION_TIME);
+    EXPECT(HostOf(*scheduler, task_id) == target);
+    EXPECT(!scheduler->Machines().IsMemoryBlocked(source));
+    ExpectInStep(*scheduler, source);
+    ExpectInStep(*scheduler, target);
+    delete scheduler;
+}
+
+static void GovernorClocksDown() {
+    // With no S0 draw to amortize, a machine with every core busy is cheapest per instruction at P3
+    MachineId_t machine_id = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    FakeSimulator::SetStatePower(machine_id, S0, 0);
+    vector<TaskId_t> task_ids;
+    for(unsigned i = 0; i < 8; i++) {
+        task_ids.push_back(AddTask(1000, X86));
+    }
+    Scheduler * scheduler = Start();
+
+    FakeSimulator::InjectArrivals();
+    FakeSimulator::Advance(CHECK_PERIOD - 1);
+    EXPECT(scheduler->Machines().ActiveTasks(machine_id) == 8);
+    EXPECT(Machine_GetInfo(machine_id).p_state == P0);
+
+    FakeSimulator::Advance(2 * CHECK_PERIOD);
+    EXPECT(Machine_GetInfo(machine_id).p_state == P3);
+    EXPECT(scheduler->Clocks().TimeInPState(machine_id, P0) == CHECK_PERIOD);
+    EXPECT(scheduler->Clocks().TimeInPState(machine_id, P3) == CHECK_PERIOD);
+
+    // An SLA warning pushes the machine to P0 at once and holds it there for a second
+    FakeSimulator::InjectSLAWarning(2 * CHECK_PERIOD + 1000, task_ids[0]);
+    FakeSimulator::Advance(2 * CHECK_PERIOD + 1000);
+    EXPECT(Machine_GetInfo(machine_id).p_state == P0);
+    FakeSimulator::Advance(2 * CHECK_PERIOD + 1000000);
+    EXPECT(Machine_GetInfo(machine_id).p_state == P0);
+    FakeSimulator::Advance(2 * CHECK_PERIOD + 1000000 + CHECK_PERIOD);
+    EXPECT(Machine_GetInfo(machine_id).p_state == P3);
+    delete scheduler;
+}
+
+static void DeadlineRaisesPriority() {
+    MachineId_t machine_id = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    TaskId_t task_id = AddTask(1000, X86);
+    Scheduler * scheduler = Start();
+
+    // SLA1 is within its budget, so the task starts low, goes to its SLA's priority halfway to its
+    // deadline and to high three quarters of the way, at the first check after each
+    FakeSimulator::InjectArrivals();
+    FakeSimulator::Advance(1000);
+    EXPECT(HostOf(*scheduler, task_id) == machine_id);
+    EXPECT(GetTaskPriority(task_id) == LOW_PRIORITY);
+
+    FakeSimulator::Advance(TASK_DEADLINE / 2);
+    EXPECT(GetTaskPriority(task_id) == LOW_PRIORITY);
+    FakeSimulator::Advance(TASK_DEADLINE / 2 + CHECK_PERIOD);
+    EXPECT(GetTaskPriority(task_id) == MID_PRIORITY);
+
+    FakeSimulator::Advance(TASK_DEADLINE * 3 / 4);
+    EXPECT(GetTaskPriority(task_id) == MID_PRIORITY);
+    FakeSimulator::Advance(TASK_DEADLINE * 3 / 4 + CHECK_PERIOD);
+    EXPECT(GetTaskPriority(task_id) == HIGH_PRIORITY);
+    delete scheduler;
+}
+
+static void CompletionModelSharesCore() {
+    MachineId_t machine_id = FakeSimulator::AddMachine(X86, 1, 16384, false);
+    TaskId_t first = AddTask(0, X86);
+    TaskId_t second = AddTask(0, X86);
+    FakeSimulator::SetCheckPeriod(0);
+    Scheduler * scheduler = Start();
+
+    // A task alone on the core runs at 3000 MIPS; two at the same priority take half the core each
+    Time_t alone = Time_t(TASK_SIZE / 3000.0);
+    VMId_t vm_id = scheduler->Residency().FirstVM(machine_id);
+    scheduler->AddTask(first, vm_id, MID_PRIORITY, TASK_MEMORY);
+    EXPECT(scheduler->Model().Predicted(first) == alone);
+    EXPECT(scheduler->Model().PredictFinish(0, machine_id, second, LOW_PRIORITY) == Time_t(2 * TASK_SIZE / 3000.0));
+    scheduler->AddTask(second, vm_id, MID_PRIORITY, TASK_MEMORY);
+    EXPECT(scheduler->Model().Predicted(second) == Time_t(2 * TASK_SIZE / 3000.0));
+    // Ahead of both, a high priority task keeps the core to itself
+    EXPECT(scheduler->Model().PredictFinish(0, machine_id, second, HIGH_PRIORITY) == alone);
+    delete scheduler;
+}
+
+static void IdleVMShutDown() {
+    MachineId_t machine_id = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    TaskId_t task_id = AddTask(0, X86);
+    Scheduler * scheduler = Start();
+
+    // The task keeps the machine up; the Windows VM next to it stays empty
+    VMId_t pinned = scheduler->Residency().FirstVM(machine_id);
+    scheduler->AddTask(task_id, pinned, MID_PRIORITY, TASK_MEMORY);
+    VMId_t windows = scheduler->ProvideVM(WIN, X86, machine_id);
+    EXPECT(windows != pinned);
+    EXPECT(scheduler->ProvideVM(WIN, X86, machine_id) == windows);
+    EXPECT(Machine_GetInfo(machine_id).active_vms == 2);
+
+    // Passes run once a second; the VM is first seen empty at the first one and shut down ten
+    // seconds later
+    FakeSimulator::Advance(11000000);
+    EXPECT(Machine_GetInfo(machine_id).active_vms == 2);
+    FakeSimulator::Advance(12000000);
+    EXPECT(Machine_GetInfo(machine_id).active_vms == 1);
+    EXPECT(Machine_GetInfo(machine_id).memory_used == VM_MEMORY_OVERHEAD + TASK_MEMORY);
+    EXPECT(scheduler->Residency().FirstVM(machine_id) == pinned);
+    EXPECT(scheduler->Residency().NextVM(pinned) == NO_VM);
+    ExpectInStep(*scheduler, machine_id);
+    delete scheduler;
+}
+
+static void ReplayFeedsArrivals() {
+    MachineId_t machine_id = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    const ReplayRecord_t records[] = {
+        { 1000, 1000 + TASK_DEADLINE, TASK_SIZE, 256, LINUX, X86, SLA0, 0 },
+        { 2000, 2000 + TASK_DEADLINE, TASK_SIZE, 512, LINUX, X86, SLA1, 0 },
+        { 3000, 3000 + TASK_DEADLINE, TASK_SIZE, 1024, LINUX, X86, SLA2, 0 },
+    };
+    char path[] = "/tmp/cloudsim-replay-XXXXXX";
+    int fd = mkstemp(path);
+    FILE * file = fdopen(fd, "wb");
+    char header[sizeof(ReplayRecord_t)] = { 'C', 'S', 'R', 'E', 'P', 'L', 'A', 'Y' };
+    uint64_t count = sizeof(records) / sizeof(records[0]);
+    memcpy(header + 8, &count, sizeof(count));
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(records, sizeof(records), 1, file);
+    fclose(file);
+
+    setenv("CLOUDSIM_REPLAY", path, 1);
+    Scheduler * scheduler = Start();
+    unsetenv("CLOUDSIM_REPLAY");
+    unlink(path);
+    EXPECT(GetNumTasks() == count);
+
+    FakeSimulator::Advance(2000);
+    EXPECT(HostOf(*scheduler, 0) == machine_id);
+    EXPECT(HostOf(*scheduler, 1) == machine_id);
+    EXPECT(HostOf(*scheduler, 2) == NO_MACHINE);
+    FakeSimulator::Advance(3000);
+    for(TaskId_t task_id = 0; task_id < count; task_id++) {
+        TaskInfo_t task_info = GetTaskInfo(task_id);
+        EXPECT(HostOf(*scheduler, task_id) == machine_id);
+        EXPECT(task_info.arrival == records[task_id].arrival);
+        EXPECT(task_info.target_completion == records[task_id].deadline);
+        EXPECT(task_info.required_memory == records[task_id].memory);
+        EXPECT(task_info.required_sla == records[task_id].sla);
+    }
+    EXPECT(Machine_GetInfo(machine_id).active_tasks == 3);
+    ExpectInStep(*scheduler, machine_id);
+    delete scheduler;
+}
+
+static void ConsolidatorDrainsMachine() {
+    MachineId_t source = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    MachineId_t target = FakeSimulator::AddMachine(X86, 8, 16384, false);
+    // A hundred seconds of work at P0 with ten minutes to do it, well worth a migration
+    TaskId_t long_task = FakeSimulator::AddTask(0, 300000000000ull, 600000000, LINUX, SLA1, X86, false, TASK_MEMORY);
+    vector<TaskId_t> task_ids;
+    for(unsigned i = 0; i < 3; i++) {
+        task_ids.push_back(AddTask(0, X86));
+    }
+    Scheduler * scheduler = Start();
+
+    // One task on eight cores is light; three is not
+    VMId_t vm_id = scheduler->Residency().FirstVM(source);
+    scheduler->AddTask(long_task, vm_id, MID_PRIORITY, TASK_MEMORY);
+    for(TaskId_t task_id : task_ids) {
+        scheduler->AddTask(task_id, scheduler->Residency().FirstVM(target), MID_PRIORITY, TASK_MEMORY);
+    }
+
+    // Passes run once a second, and the source has to be light at five of them in a row
+    FakeSimulator::Advance(5000000);
+    EXPECT(!scheduler->IsMigrating(vm_id));
+    FakeSimulator::Advance(6000000);
+    EXPECT(scheduler->IsMigrating(vm_id));
+    EXPECT(Machine_GetInfo(source).active_tasks == 0);
+
+    FakeSimulator::Advance(6000000 + MIGRATION_TIME);
+    EXPECT(HostOf(*scheduler, long_task) == target);
+    EXPECT(Machine_GetInfo(source).active_tasks == 0);
+    EXPECT(Machine_GetInfo(target).active_tasks == 4);
+    EXPECT(Machine_GetInfo(target).active_vms == 2);
+    ExpectInStep(*scheduler, source);
+    ExpectInStep(*scheduler, target);
+    delete scheduler;
+}
+
+struct TestCase {
+    const char * name;
+    void (*run)();
+};
+
+static const TestCase cases[] = {
+    { "placed_on_awake_machine",        PlacedOnAwakeMachine },
+    { "queued_until_machine_wakes",     QueuedUntilMachineWakes },
+    { "migration_keeps_shadow_in_step", MigrationKeepsShadowInStep },
+    { "completion_during_migration",    CompletionDuringMigration },
+    { "memory_warning_evacuates",       MemoryWarningEvacuates },
+    { "governor_clocks_down",           GovernorClocksDown },
+    { "deadline_raises_priority",       DeadlineRaisesPriority },
+    { "completion_model_shares_core",   CompletionModelSharesCore },
+    { "idle_vm_shut_down",              IdleVMShutDown },
+    { "replay_feeds_arrivals",          ReplayFeedsArrivals },
+    { "consolidator_drains_machine",    ConsolidatorDrainsMachine },
+};
+
+int main(int argc, char * argv[]) {
+    // FakeSimulator only prints level 0
+    SetLogLevel(0);
+    unsigned failed = 0, run = 0;
+    for(const TestCase & test : cases) {
+        bool selected = argc == 1;
+        for(int i = 1; i < argc; i++) {
+            selected |= strcmp(argv[i], test.name) == 0;
+        }
+        if(!selected) {
+            continue;
+        }
+        FakeSimulator::Reset();
+        passed = true;
+        test.run();
+        printf("%-32s %s\n", test.name, passed ? "ok" : "FAILED");
+        failed += !passed;
+        run++;
+    }
+    printf("%u of %u passed\n", run - failed, run);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+//
+//  Trace.cpp
+//  CloudSim
+//
+
+#include "Trace.hpp"
+
+#include <cstdlib>
+#include <fstream>
+
+#include "Log.hpp"
+
+// Environment variable naming the file the trace is written to
+#define TRACE_VARIABLE  "CLOUDSIM_TRACE"
+// How often the energy meters are read, in microseconds
+#define ENERGY_PERIOD   1000000
+
+static_assert(sizeof(TraceRecord_t) == 32, "trace records are written to disk as is");
+
+namespace DecisionTrace {
+    bool enabled = false;
+
+    static string path;
+    static ofstream out;
+    static uint64_t records = 0;
+    static Time_t last_sample = 0;
+
+    void Init() {
+        const char * trace_path = getenv(TRACE_VARIABLE);
+        if(trace_path == nullptr || *trace_path == '\0') {
+            return;
+        }
+        path = trace_path;
+        out.open(path, ios::binary | ios::trunc);
+        if(!out) {
+            ThrowException("DecisionTrace::Init(): Cannot open " + path);
+        }
+        out.write("CSTRACE1", 8);
+        records = 0;
+        enabled = true;
+
+        // What the machines are and where they start, so the analyzer needs nothing but the trace
+        for(MachineId_t machine_id = 0; machine_id < Machine_GetTotal(); machine_id++) {
+            MachineInfo_t info = Machine_GetInfo(machine_id);
+            Append(TRACE_MACHINE, -1, -1, machine_id, info.num_cpus, info.memory_size);
+            Append(TRACE_S_STATE_DONE, -1, -1, machine_id, info.s_state, info.energy_consumed);
+        }
+        last_sample = Now();
+    }
+
+    void Append(TraceEvent_t event, TaskId_t task_id, VMId_t vm_id, MachineId_t machine_id, unsigned arg, uint64_t value) {
+        TraceRecord_t record = { Now(), value, task_id, vm_id, machine_id, event, uint16_t(arg) };
+        out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        records++;
+    }
+
+    void Sample(Time_t now, bool force) {
+        if(!enabled || (!force && now - last_sample < ENERGY_PERIOD)) {
+            return;
+        }
+        last_sample = now;
+        for(MachineId_t machine_id = 0; machine_id < Machine_GetTotal(); machine_id++) {
+            Append(TRACE_ENERGY, -1, -1, machine_id, 0, Machine_GetEnergy(machine_id));
+        }
+    }
+
+    void Close() {
+        if(!enabled) {
+            return;
+        }
+        out.close();
+        enabled = false;
+        LOG("DecisionTrace::Close(): " + to_string(records) + " decisions written to " + path, 1);
+    }
+}
@@ -0,0 +1,84 @@
+//
+//  Trace.hpp
+//  CloudSim
+//
+
+#ifndef Trace_hpp
+#define Trace_hpp
+
+#include <cstdint>
+
+#include "Interfaces.h"
+#include "SimTypes.h"
+
+// Binary trace of the scheduler's decisions, for diagnosing a run after the fact with
+// trace_analyze.py instead of rerunning it at -v 4. Off unless CLOUDSIM_TRACE names the file to
+// write; then every decision appends one fixed 32 byte record to it as the run goes, and every
+// machine's energy meter is sampled once a second so the analyzer can attribute the energy.
+//
+// File layout, little endian: "CSTRACE1", then records until the end of the file. Ids that do not
+// apply to an event are -1; arg and value are event specific:
+//
+//  event                   task vm machine  arg             value
+//  TRACE_MACHINE                     x      cores           memory
+//  TRACE_TASK_ARRIVED      x                SLA             deadline
+//  TRACE_TASK_QUEUED       x
+//  TRACE_TASK_DROPPED      x
+//  TRACE_TASK_PLACED       x    x    x      priority        predicted finish
+//  TRACE_TASK_COMPLETED    x    x    x
+//  TRACE_VM_CREATED             x    x      VM type
+//  TRACE_MIGRATION_STARTED      x    x                      source machine
+//  TRACE_MIGRATION_DONE         x    x                      source machine
+//  TRACE_S_STATE_REQUESTED           x      S-state
+//  TRACE_S_STATE_DONE                x      S-state         energy so far
+//  TRACE_P_STATE                     x      P-state
+//  TRACE_SLA_WARNING       x    x    x
+//  TRACE_MEMORY_WARNING              x
+//  TRACE_ENERGY                      x                      energy so far
+//
+// Energy is in watt-microseconds, times in microseconds.
+enum TraceEvent_t : uint16_t {
+    TRACE_MACHINE,
+    TRACE_TASK_ARRIVED,
+    TRACE_TASK_QUEUED,
+    TRACE_TASK_DROPPED,
+    TRACE_TASK_PLACED,
+    TRACE_TASK_COMPLETED,
+    TRACE_VM_CREATED,
+    TRACE_MIGRATION_STARTED,
+    TRACE_MIGRATION_DONE,
+    TRACE_S_STATE_REQUESTED,
+    TRACE_S_STATE_DONE,
+    TRACE_P_STATE,
+    TRACE_SLA_WARNING,
+    TRACE_MEMORY_WARNING,
+    TRACE_ENERGY
+};
+
+struct TraceRecord_t {
+    Time_t time;
+    uint64_t value;
+    uint32_t task;
+    uint32_t vm;
+    uint32_t machine;
+    uint16_t event;
+    uint16_t arg;
+};
+
+namespace DecisionTrace {
+    extern bool enabled;
+
+    void Init();
+    void Append(TraceEvent_t event, TaskId_t task_id, VMId_t vm_id, MachineId_t machine_id, unsigned arg, uint64_t value);
+    // Energy samples, at most once a period unless forced
+    void Sample(Time_t now, bool force);
+    void Close();
+}
+
+inline void Trace(TraceEvent_t event, TaskId_t task_id, VMId_t vm_id, MachineId_t machine_id, unsigned arg = 0, uint64_t value = 0) {
+    if(DecisionTrace::enabled) {
+        DecisionTrace::Append(event, task_id, vm_id, machine_id, arg, value);
+    }
+}
+
+#endif /* Trace_hpp */
@@ -0,0 +1,81 @@
+//
+//  UpcallTimer.cpp
+//  CloudSim
+//
+
+#include "UpcallTimer.hpp"
+
+#include <algorithm>
+
+#include "Log.hpp"
+
+// Values below 2^SUB_BITS get a bucket each; above, a value's bucket is its power of two and the
+// SUB_BITS bits below the leading one
+unsigned LatencyHistogram::BucketOf(uint64_t value) {
+    if(value < (1u << SUB_BITS)) {
+        return unsigned(value);
+    }
+    unsigned magnitude = 63 - __builtin_clzll(value);
+    unsigned shift = magnitude - SUB_BITS;
+    return ((shift + 1) << SUB_BITS) + unsigned((value >> shift) & ((1u << SUB_BITS) - 1));
+}
+
+uint64_t LatencyHistogram::UpperEdge(unsigned bucket) {
+    if(bucket < (1u << SUB_BITS)) {
+        return bucket;
+    }
+    unsigned shift = (bucket >> SUB_BITS) - 1;
+    uint64_t sub = bucket & ((1u << SUB_BITS) - 1);
+    return (((1ull << SUB_BITS) + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t nanoseconds) {
+    buckets[BucketOf(nanoseconds)]++;
+    count++;
+    total += nanoseconds;
+    max = std::max(max, nanoseconds);
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const {
+    uint64_t rank = uint64_t(fraction * count + 0.5);
+    uint64_t seen = 0;
+    for(unsigned bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += buckets[bucket];
+        if(seen >= rank && seen > 0) {
+            return std::min(UpperEdge(bucket), max);
+        }
+    }
+    return max;
+}
+
+namespace UpcallTiming {
+    LatencyHistogram histograms[UPCALLS];
+
+    static chrono::steady_clock::time_point started;
+
+    void Start() {
+        started = chrono::steady_clock::now();
+    }
+
+    void Report() {
+#if UPCALL_TIMING
+        static const char * upcall_names[UPCALLS] = {
+            "HandleNewTask", "HandleTaskCompletion", "SchedulerCheck", "SLAWarning", "MigrationDone", "MemoryWarning", "StateChangeComplete"
+        };
+        double wall = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        double in_scheduler = 0;
+        for(unsigned upcall = 0; upcall < UPCALLS; upcall++) {
+            const LatencyHistogram & histogram = histograms[upcall];
+            in_scheduler += histogram.Total() / 1e9;
+            if(histogram.Count() == 0) {
+                continue;
+            }
+            LOG("UpcallTiming::Report(): " + string(upcall_names[upcall]) + ": " + to_string(histogram.Count()) + " calls, mean "
+                + to_string(histogram.Total() / histogram.Count()) + " ns, p50 " + to_string(histogram.Percentile(0.5))
+                + " ns, p99 " + to_string(histogram.Percentile(0.99)) + " ns, max " + to_string(histogram.Max())
+                + " ns, total " + to_string(histogram.Total() / 1e9) + " s", 1);
+        }
+        LOG("UpcallTiming::Report(): Scheduler took " + to_string(in_scheduler) + " s of " + to_string(wall) + " s wall time", 1);
+#endif
+    }
+}
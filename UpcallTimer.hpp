@@ -0,0 +1,83 @@
+//
+//  UpcallTimer.hpp
+//  CloudSim
+//
+
+#ifndef UpcallTimer_hpp
+#define UpcallTimer_hpp
+
+#include <chrono>
+#include <cstdint>
+
+#include "SimTypes.h"
+
+// Wall clock spent in the scheduler's upcalls, against the run as a whole. Every timed upcall
+// lands in a log-linear histogram: 8 sub-buckets per power of two, so any latency is known to
+// within 12.5% from a few hundred counters and recording is a couple of shifts. The histograms are
+// printed at level 1 when the simulation completes.
+//
+// Timing costs two reads of the monotonic clock per upcall. Build with -DUPCALL_TIMING=0 to
+// compile it out, TIME_UPCALL() then expands to nothing.
+#ifndef UPCALL_TIMING
+#define UPCALL_TIMING 1
+#endif
+
+enum Upcall_t {
+    UPCALL_NEW_TASK,
+    UPCALL_TASK_COMPLETE,
+    UPCALL_SCHEDULER_CHECK,
+    UPCALL_SLA_WARNING,
+    UPCALL_MIGRATION_DONE,
+    UPCALL_MEMORY_WARNING,
+    UPCALL_STATE_CHANGE,
+    UPCALLS
+};
+
+class LatencyHistogram {
+public:
+    void Record(uint64_t nanoseconds);
+    // Upper edge of the bucket holding the given fraction of the samples
+    uint64_t Percentile(double fraction) const;
+    uint64_t Count() const                          { return count; }
+    uint64_t Total() const                          { return total; }
+    uint64_t Max() const                            { return max; }
+private:
+    static const unsigned SUB_BITS = 3;
+    static const unsigned BUCKETS = (64 - SUB_BITS + 1) << SUB_BITS;
+
+    static unsigned BucketOf(uint64_t value);
+    static uint64_t UpperEdge(unsigned bucket);
+
+    uint64_t buckets[BUCKETS] = {};
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t max = 0;
+};
+
+namespace UpcallTiming {
+    extern LatencyHistogram histograms[UPCALLS];
+
+    // Starts the clock the upcall times are compared against
+    void Start();
+    void Report();
+}
+
+class UpcallTimer {
+public:
+    explicit UpcallTimer(Upcall_t upcall) : upcall(upcall), start(chrono::steady_clock::now()) {}
+    ~UpcallTimer() {
+        auto elapsed = chrono::steady_clock::now() - start;
+        UpcallTiming::histograms[upcall].Record(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    }
+private:
+    Upcall_t upcall;
+    chrono::steady_clock::time_point start;
+};
+
+#if UPCALL_TIMING
+#define TIME_UPCALL(upcall) UpcallTimer upcall_timer(upcall)
+#else
+#define TIME_UPCALL(upcall) do {} while(0)
+#endif
+
+#endif /* UpcallTimer_hpp */
@@ -0,0 +1,78 @@
+//
+//  VMPool.cpp
+//  CloudSim
+//
+
+#include "VMPool.hpp"
+
+#include <algorithm>
+
+#include "Interfaces.h"
+#include "Log.hpp"
+#include "Scheduler.hpp"
+
+// Time between passes over the VMs, in microseconds
+#define VM_REAP_PERIOD  1000000
+// An empty VM is shut down once it has been empty this long, in microseconds
+#define VM_IDLE_LIMIT   10000000
+
+#define NOT_IDLE        Time_t(-1)
+
+VMId_t VMPool::Reuse(const Scheduler & scheduler, VMType_t vm_type, MachineId_t machine_id) {
+    for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+        if(residency.TaskCount(vm_id) == 0 && placement.TypeOf(vm_id) == vm_type && !scheduler.IsMigrating(vm_id)) {
+            idle_since[vm_id] = NOT_IDLE;
+            reused++;
+            return vm_id;
+        }
+    }
+    return NO_VM;
+}
+
+void VMPool::Created(Time_t now, VMId_t vm_id) {
+    if(vm_id >= idle_since.size()) {
+        idle_since.resize(vm_id + 1, NOT_IDLE);
+        pinned.resize(vm_id + 1, false);
+    }
+    // Created for a task that is about to land on it
+    idle_since[vm_id] = NOT_IDLE;
+    created++;
+    live++;
+    peak = max(peak, live);
+}
+
+void VMPool::PeriodicCheck(Scheduler & scheduler, Time_t now) {
+    if(now - last_pass < VM_REAP_PERIOD) {
+        return;
+    }
+    last_pass = now;
+
+    expired.clear();
+    for(MachineId_t machine_id = 0; machine_id < machines.Total(); machine_id++) {
+        bool ready = machines.IsReady(machine_id) && !machines.IsChanging(machine_id);
+        for(VMId_t vm_id = residency.FirstVM(machine_id); vm_id != NO_VM; vm_id = residency.NextVM(vm_id)) {
+            if(pinned[vm_id] || residency.TaskCount(vm_id) != 0 || scheduler.IsMigrating(vm_id)) {
+                idle_since[vm_id] = NOT_IDLE;
+                continue;
+            }
+            if(idle_since[vm_id] == NOT_IDLE) {
+                idle_since[vm_id] = now;
+            }
+            else if(ready && now - idle_since[vm_id] >= VM_IDLE_LIMIT) {
+                expired.push_back(vm_id);
+            }
+        }
+    }
+    for(VMId_t vm_id : expired) {
+        LOG("VMPool::PeriodicCheck(): Shutting down VM " + to_string(vm_id) + ", empty since " + to_string(idle_since[vm_id]), 3);
+        scheduler.ShutdownVM(vm_id);
+        idle_since[vm_id] = NOT_IDLE;
+        reaped++;
+        live--;
+    }
+}
+
+void VMPool::Report() const {
+    LOG("VMPool::Report(): " + to_string(created) + " VMs created, " + to_string(reused) + " empty ones reused instead, "
+        + to_string(reaped) + " shut down while idle, at most " + to_string(peak) + " at once", 1);
+}
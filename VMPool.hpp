@@ -0,0 +1,56 @@
+//
+//  VMPool.hpp
+//  CloudSim
+//
+
+#ifndef VMPool_hpp
+#define VMPool_hpp
+
+#include <vector>
+
+#include "MachineShadow.hpp"
+#include "PlacementIndex.hpp"
+#include "ReverseIndex.hpp"
+#include "SimTypes.h"
+
+class Scheduler;
+
+// VM lifecycle. Every machine starts with one pinned VM of its native type, which stays: the
+// placement index only finds a machine through its VMs. Any other VM is created when a policy asks
+// for one, unless the machine already has an empty VM of that type, which is handed out instead.
+// Empty VMs also stay in the placement buckets for the next task of their type, and one that has
+// stayed empty for VM_IDLE_LIMIT is shut down, giving its memory overhead back and keeping the VM
+// lists as long as the live workload needs. Only VMs on machines in S0 are shut down; parked
+// machines refuse to detach VMs.
+class VMPool {
+public:
+    VMPool(const MachineShadow & machines, const PlacementIndex & placement, const ReverseIndex & residency)
+        : machines(machines), placement(placement), residency(residency) {}
+
+    // An empty VM of the type on the machine to hand out instead of a new one, or NO_VM
+    VMId_t Reuse(const Scheduler & scheduler, VMType_t vm_type, MachineId_t machine_id);
+    void Created(Time_t now, VMId_t vm_id);
+    // The VM is never shut down
+    void Pin(VMId_t vm_id)                      { pinned[vm_id] = true; }
+    // Shuts VMs down through Scheduler::ShutdownVM
+    void PeriodicCheck(Scheduler & scheduler, Time_t now);
+    void Report() const;
+private:
+    const MachineShadow & machines;
+    const PlacementIndex & placement;
+    const ReverseIndex & residency;
+
+    Time_t last_pass = 0;
+    vector<Time_t> idle_since;                  // Per VM, since when it has been seen empty
+    vector<char> pinned;                        // Per VM
+    unsigned live = 0;
+    unsigned peak = 0;
+    unsigned created = 0;
+    unsigned reaped = 0;
+    unsigned reused = 0;
+
+    // Scratch space for PeriodicCheck
+    vector<VMId_t> expired;
+};
+
+#endif /* VMPool_hpp */
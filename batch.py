@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+#  batch.py
+#  CloudSim
+#
+# Runs a matrix of policy x input file x seed as separate scheduler processes, spread over all local
+# cores, and collects energy, SLA violations and runtime into a CSV plus per policy and input summary
+# statistics.
+#
+# Each seed rewrites the Seed: field of every task class in the input: seed s adds s to the seed the
+# file gives, so seed 0 runs the file exactly as written and every stanza still gets its own stream.
+#
+# The runs are processes rather than threads of one process because the simulator keeps its state
+# in globals of the prebuilt objects; the scheduler side is already one Scheduler instance per run.
+# Each reseeded input is written once and shared by all policies.
+#
+# Example:
+#     python3 batch.py --policies best greedy --inputs Nice Spikey --seeds 10 --out results.csv
+#
+
+import argparse
+import csv
+import math
+import os
+import re
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+POLICIES = ["best", "brute", "greedy"]
+METRICS = ["energy_kwh", "sla0", "sla1", "sla2", "sim_seconds", "wall_seconds"]
+
+SEED_LINE = re.compile(r"^(\s*Seed:\s*)(\d+)", re.MULTILINE)
+RESULT_PATTERNS = {
+    "sla0": re.compile(r"^SLA0: ([0-9.eE+-]+)%", re.MULTILINE),
+    "sla1": re.compile(r"^SLA1: ([0-9.eE+-]+)%", re.MULTILINE),
+    "sla2": re.compile(r"^SLA2: ([0-9.eE+-]+)%", re.MULTILINE),
+    "energy_kwh": re.compile(r"^Total Energy ([0-9.eE+-]+)KW-Hour", re.MULTILINE),
+    "sim_seconds": re.compile(r"^Simulation run finished in ([0-9.eE+-]+) seconds", re.MULTILINE),
+}
+
+# Two sided 95% Student t critical values by degrees of freedom; the normal value past the table
+T_95 = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+
+
+def reseed(text, seed):
+    return SEED_LINE.sub(lambda match: match.group(1) + str(int(match.group(2)) + seed), text)
+
+
+def write_inputs(paths, seeds, workdir):
+    # One reseeded copy per input and seed, shared by every policy's run of it. The index keeps apart
+    # inputs that share a file name in different directories.
+    run_inputs = {}
+    for index, path in enumerate(paths):
+        with open(path) as source:
+            text = source.read()
+        for seed in range(seeds):
+            run_input = os.path.join(workdir, "%d-%s.%d" % (index, os.path.basename(path), seed))
+            with open(run_input, "w") as target:
+                target.write(reseed(text, seed))
+            run_inputs[path, seed] = run_input
+    return run_inputs
+
+
+def run_one(binary, policy, input_path, seed, run_input, timeout):
+    row = {"policy": policy, "input": input_path, "seed": seed}
+    env = dict(os.environ, CLOUDSIM_POLICY=policy)
+    start = time.monotonic()
+    try:
+        result = subprocess.run([binary, run_input], env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                universal_newlines=True, timeout=timeout)
+        output, status = result.stdout, "ok" if result.returncode == 0 else "exit %d" % result.returncode
+    except subprocess.TimeoutExpired as expired:
+        output, status = expired.stdout or "", "timeout"
+        if isinstance(output, bytes):
+            output = output.decode(errors="replace")
+    row["wall_seconds"] = round(time.monotonic() - start, 3)
+
+    for metric, pattern in RESULT_PATTERNS.items():
+        match = pattern.search(output)
+        row[metric] = float(match.group(1)) if match else None
+    if status == "ok" and row["energy_kwh"] is None:
+        status = "no report"
+    row["status"] = status
+    return row
+
+
+def percentile(values, fraction):
+    # Nearest rank
+    ordered = sorted(values)
+    return ordered[max(0, math.ceil(fraction * len(ordered)) - 1)]
+
+
+def summarize(values):
+    mean = statistics.mean(values)
+    if len(values) < 2:
+        return mean, percentile(values, 0.95), 0.0
+    t = T_95[len(values) - 2] if len(values) - 1 <= len(T_95) else 1.960
+    return mean, percentile(values, 0.95), t * statistics.stdev(values) / math.sqrt(len(values))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the scheduler over policies x inputs x seeds and collect the results.")
+    parser.add_argument("--binary", default="./scheduler", help="scheduler binary (default ./scheduler)")
+    parser.add_argument("--policies", nargs="+", default=POLICIES, help="policies to run (default all)")
+    parser.add_argument("--inputs", nargs="+", required=True, help="input files")
+    parser.add_argument("--seeds", type=int, default=5, help="number of seeds per policy and input, 0 to n-1 (default 5)")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="runs at a time (default: number of cores)")
+    parser.add_argument("--timeout", type=float, default=3600, help="seconds before a run is killed (default 3600)")
+    parser.add_argument("--out", default="results.csv", help="CSV of every run (default results.csv)")
+    parser.add_argument("--summary", help="also write the summary statistics to this CSV")
+    args = parser.parse_args()
+
+    # Inputs are told apart by their path as given, so same named files from different directories stay
+    # separate; naming one file twice runs it once
+    inputs = list(dict.fromkeys(os.path.normpath(path) for path in args.inputs))
+    matrix = [(policy, path, seed) for policy in args.policies for path in inputs for seed in range(args.seeds)]
+    rows = []
+    with tempfile.TemporaryDirectory(prefix="cloudsim-batch-") as workdir:
+        run_inputs = write_inputs(inputs, args.seeds, workdir)
+        with ThreadPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+            futures = [pool.submit(run_one, args.binary, policy, path, seed, run_inputs[path, seed], args.timeout)
+                       for policy, path, seed in matrix]
+            for done, future in enumerate(futures, 1):
+                row = future.result()
+                rows.append(row)
+                print("[%d/%d] %s %s seed %d: %s" % (done, len(matrix), row["policy"], row["input"], row["seed"], row["status"]), file=sys.stderr)
+
+    columns = ["policy", "input", "seed"] + METRICS + ["status"]
+    with open(args.out, "w", newline="") as out:
+        writer = csv.DictWriter(out, fieldnames=columns)
+        writer.writeheader()
+        writer.writerows(rows)
+
+    summary = []
+    for policy in args.policies:
+        for path in inputs:
+            runs = [row for row in rows if row["policy"] == policy and row["input"] == path and row["status"] == "ok"]
+            for metric in METRICS:
+                values = [row[metric] for row in runs if row[metric] is not None]
+                if not values:
+                    continue
+                mean, p95, ci = summarize(values)
+                summary.append({"policy": policy, "input": path, "metric": metric, "runs": len(values),
+                                "mean": mean, "p95": p95, "ci95": ci})
+
+    print("%-8s %-14s %-13s %5s %14s %14s %14s" % ("policy", "input", "metric", "runs", "mean", "p95", "+/- 95% CI"))
+    for entry in summary:
+        print("%-8s %-14s %-13s %5d %14.6g %14.6g %14.6g" % (entry["policy"], entry["input"], entry["metric"], entry["runs"],
+                                                           entry["mean"], entry["p95"], entry["ci95"]))
+    if args.summary:
+        with open(args.summary, "w", newline="") as out:
+            writer = csv.DictWriter(out, fieldnames=["policy", "input", "metric", "runs", "mean", "p95", "ci95"])
+            writer.writeheader()
+            writer.writerows(summary)
+
+    failed = sum(1 for row in rows if row["status"] != "ok")
+    if failed:
+        print("%d of %d runs failed, see the status column of %s" % (failed, len(rows), args.out), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
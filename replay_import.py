@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+#  replay_import.py
+#  CloudSim
+#
+# Converts a CSV workload trace into the binary file the scheduler replays when CLOUDSIM_REPLAY
+# names it (format in Replay.hpp). The CSV needs a header row with these columns, in any order:
+#
+#     arrival         arrival time in microseconds
+#     instructions    task length in instructions
+#     memory          memory in MB
+#     vm_type         LINUX, LINUX_RT, WIN or AIX
+#     cpu_type        ARM, POWER, RISCV or X86
+#     gpu             yes/no, true/false or 1/0
+#     sla             SLA0 to SLA3
+#     deadline        optional, absolute target completion in microseconds
+#
+# Without a deadline the task gets the slack the input file format would give a task class whose
+# expected runtime is this task's runtime at 1000 MIPS: 3x the runtime for SLA0, 8x for SLA1 and 12x
+# for SLA2 and SLA3, on top of the runtime itself.
+#
+# Rows are converted one at a time, so traces larger than memory are fine, but they have to be
+# sorted by arrival already.
+#
+# Example:
+#     python3 replay_import.py production.csv production.replay
+#     CLOUDSIM_REPLAY=production.replay ./scheduler MachinesOnly
+#
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = b"CSREPLAY"
+HEADER = struct.Struct("<8sQQQ")                # Padded to the size of a record
+RECORD = struct.Struct("<QQQIBBBB")
+
+VM_TYPES = {"LINUX": 0, "LINUX_RT": 1, "WIN": 2, "AIX": 3}
+CPU_TYPES = {"ARM": 0, "POWER": 1, "RISCV": 2, "X86": 3}
+SLAS = {"SLA0": 0, "SLA1": 1, "SLA2": 2, "SLA3": 3}
+SLACK = [3, 8, 12, 12]
+TRUE = {"yes", "true", "1"}
+FALSE = {"no", "false", "0"}
+
+
+def lookup(table, value, column, line):
+    key = value.strip().upper()
+    if key not in table:
+        sys.exit("line %d: unknown %s %r, expected one of %s" % (line, column, value, ", ".join(table)))
+    return table[key]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a CSV workload trace into a scheduler replay file.")
+    parser.add_argument("csv", help="CSV trace, sorted by arrival")
+    parser.add_argument("out", help="replay file to write")
+    args = parser.parse_args()
+
+    count = 0
+    last_arrival = 0
+    with open(args.csv, newline="") as source, open(args.out, "wb") as out:
+        out.write(HEADER.pack(MAGIC, 0, 0, 0))
+        for line, row in enumerate(csv.DictReader(source), 2):
+            try:
+                arrival = int(row["arrival"])
+                instructions = int(row["instructions"])
+                memory = int(row["memory"])
+                gpu = row["gpu"].strip().lower()
+                if gpu not in TRUE | FALSE:
+                    sys.exit("line %d: gpu must be yes or no, not %r" % (line, row["gpu"]))
+                sla = lookup(SLAS, row["sla"], "sla", line)
+                deadline = row.get("deadline") or ""
+                if deadline.strip():
+                    deadline = int(deadline)
+                else:
+                    runtime = instructions // 1000
+                    deadline = arrival + runtime * (1 + SLACK[sla])
+                record = RECORD.pack(arrival, deadline, instructions, memory, lookup(VM_TYPES, row["vm_type"], "vm_type", line),
+                                     lookup(CPU_TYPES, row["cpu_type"], "cpu_type", line), sla, 1 if gpu in TRUE else 0)
+            except KeyError as missing:
+                sys.exit("line %d: missing column %s" % (line, missing))
+            except ValueError as error:
+                sys.exit("line %d: %s" % (line, error))
+            if arrival < last_arrival:
+                sys.exit("line %d: arrivals must be sorted, %d comes after %d" % (line, arrival, last_arrival))
+            last_arrival = arrival
+            out.write(record)
+            count += 1
+        out.seek(0)
+        out.write(HEADER.pack(MAGIC, count, 0, 0))
+    print("%d tasks written to %s" % (count, args.out))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
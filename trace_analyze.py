@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+#
+#  trace_analyze.py
+#  CloudSim
+#
+# Reads the binary decision trace a run writes when CLOUDSIM_TRACE names a file (format in Trace.hpp)
+# and reports:
+#   - per machine utilization: busy core share over time, time in each S-state, and optionally the
+#     whole timeline in fixed width bins as CSV
+#   - per SLA latency distributions (completion - arrival), violations against the deadline, and how
+#     far the scheduler's predicted finish times were off
+#   - energy attribution: each machine's metered energy split over the SLA classes of the tasks it
+#     ran, in proportion to their share of the machine over time, with the rest charged to idle time
+#     and to time spent parked. A machine counts as parked from the moment it finished going down to
+#     the moment it finished coming back up.
+#
+# Example:
+#     CLOUDSIM_TRACE=run.trace ./scheduler BigSmall
+#     python3 trace_analyze.py run.trace --timeline timeline.csv --bin 1
+#
+
+import argparse
+import collections
+import csv
+import math
+import struct
+import sys
+
+MAGIC = b"CSTRACE1"
+RECORD = struct.Struct("<QQIIIHH")
+
+(TRACE_MACHINE, TRACE_TASK_ARRIVED, TRACE_TASK_QUEUED, TRACE_TASK_DROPPED, TRACE_TASK_PLACED, TRACE_TASK_COMPLETED,
+ TRACE_VM_CREATED, TRACE_MIGRATION_STARTED, TRACE_MIGRATION_DONE, TRACE_S_STATE_REQUESTED, TRACE_S_STATE_DONE,
+ TRACE_P_STATE, TRACE_SLA_WARNING, TRACE_MEMORY_WARNING, TRACE_ENERGY) = range(15)
+
+SLAS = ["SLA0", "SLA1", "SLA2", "SLA3"]
+# Energy is in watt-microseconds
+WATT_US_PER_KWH = 3.6e12
+
+
+def read_trace(path):
+    with open(path, "rb") as trace:
+        data = trace.read()
+    if data[:len(MAGIC)] != MAGIC:
+        sys.exit("%s is not a decision trace" % path)
+    body = data[len(MAGIC):]
+    usable = len(body) - len(body) % RECORD.size
+    if usable != len(body):
+        print("warning: trace ends in a partial record, the run was probably cut short", file=sys.stderr)
+    return RECORD.iter_unpack(body[:usable])
+
+
+class Machine:
+    def __init__(self, cores):
+        self.cores = cores
+        self.state = 0
+        self.tasks = collections.Counter()     # Resident tasks by SLA
+        self.last_time = None
+        # Since the last energy sample: seconds charged to each SLA, idle and parked
+        self.share = collections.Counter()
+        self.last_energy = None
+        # Whole run
+        self.energy = collections.Counter()
+        self.busy_core_time = 0.0
+        self.state_time = collections.Counter()
+        self.bins = collections.defaultdict(float)
+
+    def advance(self, time, bin_width):
+        if self.last_time is None:
+            self.last_time = time
+        if time <= self.last_time:
+            return
+        start, span = self.last_time, (time - self.last_time) / 1e6
+        self.state_time[self.state] += span
+        resident = sum(self.tasks.values())
+        if self.state != 0:
+            self.share["parked"] += span
+        elif resident == 0:
+            self.share["idle"] += span
+        else:
+            for sla, count in self.tasks.items():
+                self.share[sla] += span * count / resident
+        busy = min(resident, self.cores) / self.cores if self.cores else 0.0
+        self.busy_core_time += busy * span
+        if bin_width:
+            # Spread the busy share over the timeline bins the span covers
+            width = bin_width * 1e6
+            t = start
+            while t < time:
+                end = min(time, (int(t // width) + 1) * width)
+                self.bins[int(t // width)] += busy * (end - t) / width
+                t = end
+        self.last_time = time
+
+    def sample(self, energy):
+        if self.last_energy is not None:
+            delta = energy - self.last_energy
+            total = sum(self.share.values())
+            if total > 0:
+                for key, seconds in self.share.items():
+                    self.energy[key] += delta * seconds / total
+            elif delta:
+                self.energy["parked" if self.state != 0 else "idle"] += delta
+        self.last_energy = energy
+        self.share.clear()
+
+
+def percentile(ordered, fraction):
+    # Nearest rank
+    return ordered[max(0, math.ceil(fraction * len(ordered)) - 1)] if ordered else 0.0
+
+
+def analyze(path, bin_width):
+    machines = {}
+    arrivals = {}               # task -> (time, SLA, deadline)
+    predicted = {}
+    task_sla = {}
+    task_vm = {}
+    vm_tasks = collections.defaultdict(set)
+    latencies = collections.defaultdict(list)
+    violations = collections.Counter()
+    prediction_error = collections.defaultdict(list)
+    counts = collections.Counter()
+    end = 0
+
+    for time, value, task, vm, machine_id, event, arg in read_trace(path):
+        end = max(end, time)
+        counts[event] += 1
+        machine = machines.get(machine_id)
+        if machine is not None:
+            machine.advance(time, bin_width)
+
+        if event == TRACE_MACHINE:
+            machines[machine_id] = Machine(arg)
+        elif event == TRACE_TASK_ARRIVED:
+            arrivals[task] = (time, arg, value)
+        elif event == TRACE_TASK_PLACED:
+            sla = arrivals[task][1] if task in arrivals else 3
+            task_sla[task] = sla
+            task_vm[task] = vm
+            vm_tasks[vm].add(task)
+            predicted[task] = (time, value)
+            machine.tasks[sla] += 1
+        elif event == TRACE_TASK_COMPLETED:
+            sla = task_sla.pop(task, None)
+            if sla is None:
+                continue
+            machine.tasks[sla] -= 1
+            vm_tasks[task_vm.pop(task)].discard(task)
+            if task in arrivals:
+                arrived, _, deadline = arrivals.pop(task)
+                latencies[sla].append((time - arrived) / 1e6)
+                if time > deadline:
+                    violations[sla] += 1
+            if task in predicted:
+                placed, finish = predicted.pop(task)
+                if time > placed:
+                    prediction_error[sla].append((finish - time) / (time - placed))
+        elif event == TRACE_MIGRATION_DONE:
+            source = machines[value]
+            source.advance(time, bin_width)
+            for moved in vm_tasks[vm]:
+                source.tasks[task_sla[moved]] -= 1
+                machine.tasks[task_sla[moved]] += 1
+        elif event == TRACE_S_STATE_DONE:
+            machine.state = arg
+            machine.sample(value)
+        elif event == TRACE_ENERGY:
+            machine.sample(value)
+
+    for machine in machines.values():
+        machine.advance(end, bin_width)
+    return machines, latencies, violations, prediction_error, counts, end
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarize a scheduler decision trace.")
+    parser.add_argument("trace", help="trace file written through CLOUDSIM_TRACE")
+    parser.add_argument("--timeline", help="write per machine utilization per bin to this CSV")
+    parser.add_argument("--bin", type=float, default=1.0, help="timeline bin width in seconds (default 1)")
+    args = parser.parse_args()
+
+    machines, latencies, violations, prediction_error, counts, end = analyze(args.trace, args.bin if args.timeline else 0)
+    duration = end / 1e6
+    print("%d machines, %d tasks placed, %d queued, %d dropped, %d migrations, %d SLA warnings, %d memory warnings over %.2f s"
+          % (len(machines), counts[TRACE_TASK_PLACED], counts[TRACE_TASK_QUEUED], counts[TRACE_TASK_DROPPED],
+             counts[TRACE_MIGRATION_DONE], counts[TRACE_SLA_WARNING], counts[TRACE_MEMORY_WARNING], duration))
+
+    print("\nLatency by SLA (seconds)")
+    print("%-5s %7s %9s %9s %9s %9s %9s %10s %12s" % ("SLA", "tasks", "mean", "p50", "p90", "p99", "max", "violated", "pred. error"))
+    for sla in sorted(latencies):
+        values = sorted(latencies[sla])
+        errors = sorted(abs(error) for error in prediction_error[sla])
+        print("%-5s %7d %9.3f %9.3f %9.3f %9.3f %9.3f %9.2f%% %11.1f%%"
+              % (SLAS[sla], len(values), sum(values) / len(values), percentile(values, 0.5), percentile(values, 0.9),
+                 percentile(values, 0.99), values[-1], 100.0 * violations[sla] / len(values), 100.0 * percentile(errors, 0.5)))
+
+    print("\nMachines")
+    print("%-7s %5s %10s %10s %10s %12s" % ("machine", "cores", "busy", "awake", "parked", "energy kWh"))
+    for machine_id in sorted(machines):
+        machine = machines[machine_id]
+        awake = min(machine.state_time[0], duration)
+        print("%-7d %5d %9.1f%% %9.1f%% %9.1f%% %12.6f"
+              % (machine_id, machine.cores, 100.0 * machine.busy_core_time / duration if duration else 0,
+                 100.0 * awake / duration if duration else 0, 100.0 * (duration - awake) / duration if duration else 0,
+                 sum(machine.energy.values()) / WATT_US_PER_KWH))
+
+    print("\nEnergy attribution")
+    attributed = collections.Counter()
+    for machine in machines.values():
+        attributed.update(machine.energy)
+    total = sum(attributed.values())
+    for key in [0, 1, 2, 3, "idle", "parked"]:
+        name = SLAS[key] if isinstance(key, int) else key
+        print("%-7s %12.6f kWh %6.1f%%" % (name, attributed[key] / WATT_US_PER_KWH, 100.0 * attributed[key] / total if total else 0))
+    print("%-7s %12.6f kWh" % ("total", total / WATT_US_PER_KWH))
+
+    if args.timeline:
+        with open(args.timeline, "w", newline="") as out:
+            writer = csv.writer(out)
+            writer.writerow(["machine", "start_seconds", "busy_share"])
+            bins = int(duration // args.bin) + 1
+            for machine_id in sorted(machines):
+                for index in range(bins):
+                    writer.writerow([machine_id, round(index * args.bin, 6), round(machines[machine_id].bins.get(index, 0.0), 4)])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())